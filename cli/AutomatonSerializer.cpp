@@ -95,13 +95,34 @@ std::string serializeNfa(const Nfa& nfa) {
 
 std::string serializeDfa(const Dfa& dfa) {
     std::ostringstream out;
-    out << "{\"kind\":\"DFA\",\"start\":" << dfa.start << ",\"states\":[";
+    out << "{\"kind\":\"DFA\",\"start\":" << dfa.start << ",\"classCount\":" << dfa.classes.count
+        << ",\"classes\":[";
+    // list the byte codes of each class once; transitions below refer to classes by index
+    for (std::size_t k = 0; k < dfa.classes.count; ++k) {
+        out << "{\"id\":" << k << ",\"codes\":[";
+        bool first = true;
+        for (int c = 0; c < 256; ++c) {
+            if (dfa.classes.map[c] != k) {
+                continue;
+            }
+            if (!first) {
+                out << ",";
+            }
+            first = false;
+            out << c;
+        }
+        out << "]}";
+        if (k + 1 < dfa.classes.count) {
+            out << ",";
+        }
+    }
+    out << "],\"states\":[";
     for (std::size_t i = 0; i < dfa.states.size(); ++i) {
         const auto& state = dfa.states[i];
         out << "{\"id\":" << i << ",\"accept\":" << (state.accept ? "true" : "false") << ",\"transitions\":[";
         bool first = true;
-        for (int c = 0; c < 256; ++c) {
-            int target = state.next[c];
+        for (std::size_t k = 0; k < dfa.classes.count; ++k) {
+            int target = dfa.transitions[i * dfa.classes.count + k];
             if (target < 0) {
                 continue;
             }
@@ -109,8 +130,7 @@ std::string serializeDfa(const Dfa& dfa) {
                 out << ",";
             }
             first = false;
-            out << "{\"code\":" << c << ",\"symbol\":\"" << charToJson(static_cast<char>(c)) << "\",\"to\":" << target
-                << "}";
+            out << "{\"class\":" << k << ",\"to\":" << target << "}";
         }
         out << "]}";
         if (i + 1 < dfa.states.size()) {
@@ -121,6 +141,18 @@ std::string serializeDfa(const Dfa& dfa) {
     return out.str();
 }
 
+std::string serializeLazyDfa(const Nfa& nfa) {
+    std::ostringstream out;
+    out << "{\"kind\":\"LazyDFA\",\"nfa\":" << serializeNfa(nfa) << "}";
+    return out.str();
+}
+
+std::string serializeShiftAnd(const Nfa& nfa) {
+    std::ostringstream out;
+    out << "{\"kind\":\"ShiftAnd\",\"nfa\":" << serializeNfa(nfa) << "}";
+    return out.str();
+}
+
 std::string serializeEfa(const Efa& efa) {
     std::ostringstream out;
     out << "{\"kind\":\"EFA\",\"pattern\":\"" << jsonEscape(efa.pattern) << "\",\"mismatchBudget\":"
@@ -182,6 +214,10 @@ std::string serializeSnapshot(const RunnerFactory::Snapshot& snapshot) {
             return serializeNfa(std::get<Nfa>(snapshot.automaton));
         case AutomatonKind::Dfa:
             return serializeDfa(std::get<Dfa>(snapshot.automaton));
+        case AutomatonKind::LazyDfa:
+            return serializeLazyDfa(std::get<Nfa>(snapshot.automaton));
+        case AutomatonKind::ShiftAnd:
+            return serializeShiftAnd(std::get<Nfa>(snapshot.automaton));
         case AutomatonKind::Efa:
             return serializeEfa(std::get<Efa>(snapshot.automaton));
         case AutomatonKind::Pda:
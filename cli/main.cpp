@@ -10,6 +10,7 @@
 #include "AutomatonPlan.hpp"
 #include "PatternSpec.hpp"
 #include "automata/runners/Runners.hpp"
+#include "automata/utils/CppEmitter.hpp"
 #include "evaluation/EvaluationHarness.hpp"
 #include "modes/ModeDispatcher.hpp"
 #include "parser/Parsers.hpp"
@@ -27,6 +28,12 @@ ModePreference parseMode(std::string value) {
     if (value == "dfa") {
         return ModePreference::Dfa;
     }
+    if (value == "lazy-dfa" || value == "lazy") {
+        return ModePreference::LazyDfa;
+    }
+    if (value == "shift-and") {
+        return ModePreference::ShiftAnd;
+    }
     if (value == "efa") {
         return ModePreference::Efa;
     }
@@ -42,6 +49,10 @@ std::string kindToString(AutomatonKind kind) {
             return "NFA";
         case AutomatonKind::Dfa:
             return "DFA";
+        case AutomatonKind::LazyDfa:
+            return "Lazy DFA";
+        case AutomatonKind::ShiftAnd:
+            return "Shift-And";
         case AutomatonKind::Efa:
             return "EFA";
         case AutomatonKind::Pda:
@@ -69,6 +80,7 @@ int main(int argc, char** argv) {
     std::string inputPath;
     std::string secondaryPath;
     std::string dumpAutomatonPath;
+    std::string emitCppPath;
     std::vector<std::string> inlineSequences;
     const bool colorEnabled = colorOutputEnabled();
 
@@ -80,6 +92,47 @@ int main(int argc, char** argv) {
             inputPath = argv[++i];
         } else if (arg == "--k" && i + 1 < argc) {
             spec.mismatchBudget = std::stoul(argv[++i]);
+        } else if (arg == "--distance" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (value == "edit") {
+                spec.distance = DistanceMetric::Edit;
+            } else if (value == "hamming") {
+                spec.distance = DistanceMetric::Hamming;
+            } else {
+                std::cerr << "Unknown distance: " << value << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--report" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (value == "all") {
+                spec.reportLimit = 0;
+            } else if (value == "best") {
+                spec.reportLimit = 1;
+            } else if (value.rfind("top=", 0) == 0 && value.size() > 4 &&
+                       value.find_first_not_of("0123456789", 4) == std::string::npos && std::stoul(value.substr(4)) > 0) {
+                spec.reportLimit = std::stoul(value.substr(4));
+            } else {
+                std::cerr << "Unknown report mode: " << value << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--dfa-cache" && i + 1 < argc) {
+            spec.dfaCacheBytes = std::stoul(argv[++i]);
+        } else if (arg == "--semantics" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (value == "leftmost-longest") {
+                spec.semantics = MatchSemantics::LeftmostLongest;
+            } else if (value == "all") {
+                spec.semantics = MatchSemantics::AllIntervals;
+            } else {
+                std::cerr << "Unknown match semantics: " << value << "\n";
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--max-dfa-states" && i + 1 < argc) {
+            spec.maxDfaStates = std::stoul(argv[++i]);
+        } else if (arg == "--dfa-stride" && i + 1 < argc) {
+            spec.dfaStride = std::stoul(argv[++i]);
+        } else if (arg == "--no-minimize") {
+            spec.minimizeDfa = false;
         } else if (arg == "--trace") {
             spec.trace = true;
         } else if (arg == "--mode" && i + 1 < argc) {
@@ -102,12 +155,20 @@ int main(int argc, char** argv) {
             inlineSequences.emplace_back(argv[++i]);
         } else if (arg == "--dump-automaton" && i + 1 < argc) {
             dumpAutomatonPath = argv[++i];
+        } else if (arg == "--emit-cpp" && i + 1 < argc) {
+            emitCppPath = argv[++i];
         } else {
             std::cerr << "Unknown or incomplete argument: " << arg << "\n";
             return EXIT_FAILURE;
         }
     }
 
+    // the generated scan() reports every interval, so it cannot reproduce a leftmost-longest run
+    if (!emitCppPath.empty() && spec.semantics == MatchSemantics::LeftmostLongest) {
+        std::cerr << "--emit-cpp only supports --semantics all\n";
+        return EXIT_FAILURE;
+    }
+
     try {
         DatasetLoader loader;
         if (!inputPath.empty()) {
@@ -136,6 +197,22 @@ int main(int argc, char** argv) {
     try {
         ModeDispatcher dispatcher;
         auto plan = dispatcher.decide(spec);
+        // only the approximate runners rank hits; every other mode would quietly report all intervals
+        if (spec.reportLimit > 0 && plan.kind != AutomatonKind::Efa) {
+            std::cerr << "--report best|top=N needs EFA mode (--k > 0 or --mode efa)\n";
+            return EXIT_FAILURE;
+        }
+        // indels only count in the approximate runners; every other mode would quietly run an exact search
+        if (spec.distance == DistanceMetric::Edit && plan.kind != AutomatonKind::Efa) {
+            std::cerr << "--distance edit needs EFA mode (--k > 0 or --mode efa)\n";
+            return EXIT_FAILURE;
+        }
+        // only the DFA runners recover match starts; the others would quietly report all intervals
+        if (spec.semantics == MatchSemantics::LeftmostLongest && plan.kind != AutomatonKind::Dfa &&
+            plan.kind != AutomatonKind::LazyDfa) {
+            std::cerr << "--semantics leftmost-longest needs DFA mode (--mode dfa or lazy-dfa)\n";
+            return EXIT_FAILURE;
+        }
         const char* cyan = "\033[96m";
         const char* magenta = "\033[95m";
         const char* bold = "\033[1m";
@@ -145,13 +222,43 @@ int main(int argc, char** argv) {
         std::cout << (colorEnabled ? bold : "") << "Pattern: " << reset << spec.pattern << "\n";
         std::cout << (colorEnabled ? bold : "") << "Datasets: " << reset << spec.datasets.size() << " sequence(s)\n";
         std::cout << (colorEnabled ? bold : "") << "Automaton Mode: " << reset
-                  << colorize(kindToString(plan.kind), magenta, colorEnabled) << "\n\n";
+                  << colorize(kindToString(plan.kind), magenta, colorEnabled) << "\n";
 
         RegexParser parser;
         RunnerFactory factory;
         RunnerFactory::Snapshot snapshot;
-        RunnerFactory::Snapshot* snapshotPtr = dumpAutomatonPath.empty() ? nullptr : &snapshot;
-        auto runner = factory.create(plan, parser, snapshotPtr);
+        auto runner = factory.create(plan, parser, &snapshot);
+        if (!snapshot.fallbackReason.empty()) {
+            std::cout << (colorEnabled ? bold : "") << "Fallback: " << reset << snapshot.fallbackReason << "\n";
+        }
+        if (snapshot.kind == AutomatonKind::Efa && snapshot.dfaStates > 0) {
+            std::cout << (colorEnabled ? bold : "") << "Determinized: " << reset << snapshot.dfaStates;
+            if (snapshot.dfaStates != snapshot.rawDfaStates) {
+                std::cout << " states (minimized from " << snapshot.rawDfaStates << ")";
+            } else {
+                std::cout << " states";
+            }
+            std::cout << " | Kernel: " << snapshot.dfaKernel << "\n";
+        }
+        if (snapshot.kind == AutomatonKind::Dfa) {
+            std::cout << (colorEnabled ? bold : "") << "DFA States: " << reset << snapshot.dfaStates;
+            if (snapshot.dfaStates != snapshot.rawDfaStates) {
+                std::cout << " (minimized from " << snapshot.rawDfaStates << ")";
+            }
+            const auto& dfa = std::get<Dfa>(snapshot.automaton);
+            std::cout << " | Kernel: " << snapshot.dfaKernel << " | Byte classes: " << dfa.classes.count << " | Table: "
+                      << dfa.transitions.size() * sizeof(int) << " bytes";
+            if (spec.dfaStride > 1) {
+                // the builder lowers the stride to fit its column and byte caps, so show what was actually used
+                std::cout << " | Stride: " << dfa.stride << " (";
+                if (dfa.stride != spec.dfaStride) {
+                    std::cout << "requested " << spec.dfaStride << ", ";
+                }
+                std::cout << dfa.strided.size() * sizeof(DfaStrideStep) << " bytes)";
+            }
+            std::cout << "\n";
+        }
+        std::cout << "\n";
 
         if (!dumpAutomatonPath.empty()) {
             auto json = serializeSnapshot(snapshot);
@@ -166,85 +273,125 @@ int main(int argc, char** argv) {
                 out << json;
             }
         }
+        if (!emitCppPath.empty()) {
+            // reuse the DFA the run is built on; other regex engines get one determinized just for the export
+            Dfa dfa;
+            if (snapshot.kind == AutomatonKind::Dfa) {
+                dfa = std::get<Dfa>(snapshot.automaton);
+            } else if (snapshot.kind == AutomatonKind::Nfa || snapshot.kind == AutomatonKind::LazyDfa ||
+                       snapshot.kind == AutomatonKind::ShiftAnd) {
+                DfaBuilder dfaBuilder;
+                dfa = dfaBuilder.build(NfaBuilder(parser).build(spec.pattern), spec.maxDfaStates);
+                if (spec.minimizeDfa) {
+                    dfa = dfaBuilder.minimize(dfa);
+                }
+            } else {
+                std::cerr << "--emit-cpp needs an exact regex automaton (NFA, Shift-And or DFA mode)\n";
+                return EXIT_FAILURE;
+            }
+            const auto source = emitCppScanner(dfa, spec.pattern);
+            if (emitCppPath == "-") {
+                std::cout << source;
+            } else {
+                std::ofstream out(emitCppPath);
+                if (!out) {
+                    std::cerr << "Failed to open C++ output path: " << emitCppPath << "\n";
+                    return EXIT_FAILURE;
+                }
+                out << source;
+            }
+        }
         Reporter reporter;
         MetricsAggregator metrics;
         TraceFormatter formatter;
 
-        for (std::size_t index = 0; index < plan.spec.datasets.size(); ++index) {
-            const auto& sequence = plan.spec.datasets[index];
-            const auto seqLabel = "Sequence #" + std::to_string(index + 1);
-            std::cout << colorize(seqLabel, "\033[93m", colorEnabled) << " (len=" << sequence.size() << ")\n";
+        // run the sequences in bounded groups so runners that interleave independent inputs can do so, and print
+        // each group before starting the next so results never pile up for the whole dataset
+        constexpr std::size_t kGroupSize = DfaRunner::kBatchLanes * 8;
+        const auto& datasets = plan.spec.datasets;
+        for (std::size_t first = 0; first < datasets.size(); first += kGroupSize) {
+            const auto last = std::min(datasets.size(), first + kGroupSize);
+            const auto results = runner->runBatch({datasets.begin() + first, datasets.begin() + last});
+            for (std::size_t index = first; index < last; ++index) {
+                const auto& sequence = datasets[index];
+                const auto seqLabel = "Sequence #" + std::to_string(index + 1);
+                std::cout << colorize(seqLabel, "\033[93m", colorEnabled) << " (len=" << sequence.size() << ")\n";
             
-            // Display RNA info if in RNA mode
-            if (!spec.rnaSecondaryStructure.empty()) {
-                std::cout << "  Sequence:    " << sequence << "\n";
-                std::cout << "  Dot-bracket: " << spec.rnaSecondaryStructure << "\n\n";
-            }
+                // Display RNA info if in RNA mode
+                if (!spec.rnaSecondaryStructure.empty()) {
+                    std::cout << "  Sequence:    " << sequence << "\n";
+                    std::cout << "  Dot-bracket: " << spec.rnaSecondaryStructure << "\n\n";
+                }
             
-            auto result = runner->run(sequence);
-            metrics.record(result);
-            reporter.add({sequence.substr(0, std::min<std::size_t>(sequence.size(), 40)), result});
+                const auto& result = results[index - first];
+                metrics.record(result);
             
-            // Display RNA validation results
-            if (result.isRnaValidation) {
-                // Check for length mismatch first
-                if (sequence.size() != spec.rnaSecondaryStructure.size()) {
-                    std::cout << "  [FAIL] Length Mismatch!\n";
-                    std::cout << "  Sequence length: " << sequence.size() << "\n";
-                    std::cout << "  Structure length: " << spec.rnaSecondaryStructure.size() << "\n";
-                    std::cout << "  -> Result: Invalid\n\n";
-                } else {
-                    // Check if sequence is valid RNA
-                    bool isValidRna = true;
-                    std::string invalidChars;
-                    for (char c : sequence) {
-                        char upper = std::toupper(c);
-                        if (upper != 'A' && upper != 'U' && upper != 'C' && upper != 'G') {
-                            isValidRna = false;
-                            invalidChars += c;
+                // Display RNA validation results
+                if (result.isRnaValidation) {
+                    // Check for length mismatch first
+                    if (sequence.size() != spec.rnaSecondaryStructure.size()) {
+                        std::cout << "  [FAIL] Length Mismatch!\n";
+                        std::cout << "  Sequence length: " << sequence.size() << "\n";
+                        std::cout << "  Structure length: " << spec.rnaSecondaryStructure.size() << "\n";
+                        std::cout << "  -> Result: Invalid\n\n";
+                    } else {
+                        // Check if sequence is valid RNA
+                        bool isValidRna = true;
+                        std::string invalidChars;
+                        for (char c : sequence) {
+                            char upper = std::toupper(c);
+                            if (upper != 'A' && upper != 'U' && upper != 'C' && upper != 'G') {
+                                isValidRna = false;
+                                invalidChars += c;
+                            }
                         }
-                    }
                     
-                    if (!isValidRna) {
-                    std::cout << "  [FAIL] Invalid RNA Sequence!\n";
-                    std::cout << "  RNA can only contain: A, U, C, G\n";
-                    std::cout << "  Invalid characters found: " << invalidChars << "\n";
-                    std::cout << "  -> Result: Invalid\n\n";
-                } else {
-                    std::cout << "  [OK] Valid RNA Bases\n";
-                    std::cout << "  Check:\n";
-                    for (const auto& bp : result.basePairs) {
-                        const char* mark = bp.valid ? "[OK]" : "[FAIL]";
-                        std::cout << "  - " << (bp.pos1 + 1) << "th nucleotide " << bp.base1
-                                  << " <-> " << (bp.pos2 + 1) << "th nucleotide " << bp.base2
-                                  << " -> " << (bp.valid ? "valid" : "invalid") << "? " << mark << "\n";
+                        if (!isValidRna) {
+                        std::cout << "  [FAIL] Invalid RNA Sequence!\n";
+                        std::cout << "  RNA can only contain: A, U, C, G\n";
+                        std::cout << "  Invalid characters found: " << invalidChars << "\n";
+                        std::cout << "  -> Result: Invalid\n\n";
+                    } else {
+                        std::cout << "  [OK] Valid RNA Bases\n";
+                        std::cout << "  Check:\n";
+                        for (const auto& bp : result.basePairs) {
+                            const char* mark = bp.valid ? "[OK]" : "[FAIL]";
+                            std::cout << "  - " << (bp.pos1 + 1) << "th nucleotide " << bp.base1
+                                      << " <-> " << (bp.pos2 + 1) << "th nucleotide " << bp.base2
+                                      << " -> " << (bp.valid ? "valid" : "invalid") << "? " << mark << "\n";
+                        }
+                        const char* parenMark = result.rnaParenthesesValid ? "[OK]" : "[FAIL]";
+                        std::cout << "  - Parentheses balanced? " << parenMark << "\n";
+                        std::cout << "  -> Result: " << colorize(result.accepted ? "Valid" : "Invalid",
+                                                                result.accepted ? "\033[32m" : "\033[31m",
+                                                                colorEnabled) << "\n\n";
+                        }
                     }
-                    const char* parenMark = result.rnaParenthesesValid ? "[OK]" : "[FAIL]";
-                    std::cout << "  - Parentheses balanced? " << parenMark << "\n";
-                    std::cout << "  -> Result: " << colorize(result.accepted ? "Valid" : "Invalid",
-                                                            result.accepted ? "\033[32m" : "\033[31m",
-                                                            colorEnabled) << "\n\n";
+                } else if (spec.trace) {
+                    std::cout << formatter.format(result);
+                } else if (!result.matches.empty()) {
+                    std::cout << colorize("  Matches: ", "\033[32m", colorEnabled);
+                    for (std::size_t m = 0; m < result.matches.size(); ++m) {
+                        const auto& match = result.matches[m];
+                        std::cout << "[" << match.first << "," << match.second << ")";
+                        if (m < result.distances.size()) {
+                            std::cout << ":" << result.distances[m];
+                        }
+                        std::cout << " ";
                     }
+                    std::cout << "\n";
+                    std::cout << "  " << highlightMatches(sequence, result.matches, colorEnabled) << "\n";
+                } else {
+                    std::cout << colorize("  No matches found.", "\033[31m", colorEnabled) << "\n";
                 }
-            } else if (spec.trace) {
-                std::cout << formatter.format(result);
-            } else if (!result.matches.empty()) {
-                std::cout << colorize("  Matches: ", "\033[32m", colorEnabled);
-                for (const auto& match : result.matches) {
-                    std::cout << "[" << match.first << "," << match.second << ") ";
-                }
-                std::cout << "\n";
-                std::cout << "  " << highlightMatches(sequence, result.matches, colorEnabled) << "\n";
-            } else {
-                std::cout << colorize("  No matches found.", "\033[31m", colorEnabled) << "\n";
-            }
             
-            if (!result.isRnaValidation) {
-                std::cout << "  States visited: " << result.statesVisited;
-                if (plan.kind == AutomatonKind::Pda) {
-                    std::cout << " | Max stack depth: " << result.stackDepth;
+                if (!result.isRnaValidation) {
+                    std::cout << "  States visited: " << result.statesVisited;
+                    if (plan.kind == AutomatonKind::Pda) {
+                        std::cout << " | Max stack depth: " << result.stackDepth;
+                    }
+                    std::cout << "\n\n";
                 }
-                std::cout << "\n\n";
             }
         }
 
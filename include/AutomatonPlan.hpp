@@ -4,7 +4,7 @@
 
 namespace automata {
 
-enum class AutomatonKind { Nfa, Dfa, Efa, Pda };
+enum class AutomatonKind { Nfa, Dfa, LazyDfa, ShiftAnd, Efa, Pda };
 
 struct AutomatonPlan {
     AutomatonKind kind{AutomatonKind::Nfa};
@@ -20,6 +20,9 @@ struct BasePairCheck {
 struct RunResult {
     bool accepted{false};
     std::vector<std::pair<std::size_t, std::size_t>> matches;
+    // edit-distance, ranked (--report best|top=N) and determinized k-mismatch searches: the distance of each
+    // entry of `matches`
+    std::vector<std::size_t> distances;
     std::vector<TraceEvent> trace;
     std::size_t statesVisited{0};
     std::size_t stackDepth{0};
@@ -34,6 +37,17 @@ class IRunner {
   public:
     virtual ~IRunner() = default;
     virtual RunResult run(const std::string& input) = 0;
+
+    // runs every input and returns the results in input order; runners that can overlap independent inputs
+    // override this, everyone else runs them one after another
+    virtual std::vector<RunResult> runBatch(const std::vector<std::string>& inputs) {
+        std::vector<RunResult> results;
+        results.reserve(inputs.size());
+        for (const auto& input : inputs) {
+            results.push_back(run(input));
+        }
+        return results;
+    }
 };
 
 using RunnerPtr = std::unique_ptr<IRunner>;
@@ -6,14 +6,33 @@
 
 namespace automata {
 
-enum class ModePreference { Auto, Nfa, Dfa, Efa, Pda, PdaOnly };
+enum class ModePreference { Auto, Nfa, Dfa, LazyDfa, ShiftAnd, Efa, Pda, PdaOnly };
+
+// AllIntervals reports every [start,end) that matches; LeftmostLongest reports non-overlapping matches,
+// each the longest one starting at the leftmost position not yet covered
+enum class MatchSemantics { AllIntervals, LeftmostLongest };
+
+// what the mismatch budget counts: substitutions only, or substitutions, insertions and deletions
+enum class DistanceMetric { Hamming, Edit };
 
 struct PatternSpec {
     std::string pattern;
     std::vector<std::string> datasets;
     std::string datasetPath;
     std::size_t mismatchBudget{0};
+    DistanceMetric distance{DistanceMetric::Hamming};
+    // approximate modes: keep only the N cheapest hits per sequence (1 = best hit, 0 = every interval in budget)
+    std::size_t reportLimit{0};
+    // cap on subset-construction states; past it the DFA mode falls back to the lazy DFA runner
+    std::size_t maxDfaStates{10000};
+    // symbols consumed per DFA table lookup (1 = plain table; 2 or 4 build a strided table)
+    std::size_t dfaStride{1};
+    // run Hopcroft minimization on the subset-construction DFA before scanning
+    bool minimizeDfa{true};
+    // memory budget (bytes) for the states and transitions cached by the lazy DFA runner
+    std::size_t dfaCacheBytes{1 << 20};
     bool trace{false};
+    MatchSemantics semantics{MatchSemantics::AllIntervals};
     bool allowDotBracket{false};
     
     // RNA validation
@@ -2,7 +2,10 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -26,10 +29,26 @@ struct NfaState {
     bool accept{false};
 };
 
+// a literal every match contains: in a match starting at s it occurs at s + offset for some offset in
+// [minOffset, maxOffset]; an empty literal means the pattern has no usable factor
+struct RequiredFactor {
+    static constexpr std::size_t kUnbounded = std::numeric_limits<std::size_t>::max();
+
+    std::string literal;
+    std::size_t minOffset{0};
+    std::size_t maxOffset{kUnbounded};
+};
+
 struct Nfa {
     int start{0};
     int accept{0};
     std::vector<NfaState> states;
+    // precomputed epsilon closure of every state in CSR form: the closure of state s is
+    // closureStates[closureOffsets[s]] .. closureStates[closureOffsets[s + 1] - 1]
+    std::vector<std::size_t> closureOffsets;
+    std::vector<int> closureStates;
+    // lets runners skip start offsets that cannot begin a match
+    RequiredFactor required;
 };
 
 class NfaBuilder {
@@ -41,31 +60,163 @@ class NfaBuilder {
     const RegexParser& parser_;
 };
 
+// byte equivalence classes: map[c] is the class of byte c, and representatives[k] is one byte of class k
+struct ByteClasses {
+    std::size_t count{1};
+    std::array<std::uint8_t, 256> map{};
+    std::vector<unsigned char> representatives{0};
+};
+
 struct DfaState {
-    std::array<int, 256> next{};
     bool accept{false};
+    // k-mismatch DFAs only: the fewest substitutions among the accepting NFA states this state stands for
+    std::size_t mismatches{0};
+};
+
+// outcome of feeding `stride` symbols to a DFA state in one lookup
+struct DfaStrideStep {
+    int to{-1};                  // state after the last symbol, -1 if the DFA died on the way
+    std::uint8_t consumed{0};    // symbols consumed before dying (equal to the stride when it survives)
+    std::uint8_t acceptMask{0};  // bit i is set when the state after symbol i + 1 is accepting
 };
 
 struct Dfa {
     int start{0};
     std::vector<DfaState> states;
+    ByteClasses classes;
+    // flat states x classes.count table; -1 marks a missing (dead) transition
+    std::vector<int> transitions;
+    RequiredFactor required;
+    // optional multi-symbol table (stride > 1): states x classes.count^stride entries, where the column is
+    // the classes of `stride` consecutive bytes read as base-classes.count digits, first byte most significant
+    std::size_t stride{1};
+    std::vector<DfaStrideStep> strided;
+    // row width of `strided` (classes.count^stride), stored so lookups multiply instead of dividing
+    std::size_t strideColumns{0};
+    // set by EfaBuilder::determinize: runners report the accepting state's mismatches as each match's distance
+    bool reportsMismatches{false};
+
+    int next(int state, unsigned char symbol) const {
+        return transitions[static_cast<std::size_t>(state) * classes.count + classes.map[symbol]];
+    }
+
+    // the class lookups do not depend on the state, so only the final load sits on the dependent chain
+    const DfaStrideStep& strideStep(int state, const char* symbols) const {
+        std::size_t column = 0;
+        for (std::size_t i = 0; i < stride; ++i) {
+            column = column * classes.count + classes.map[static_cast<unsigned char>(symbols[i])];
+        }
+        return strided[static_cast<std::size_t>(state) * strideColumns + column];
+    }
+};
+
+// thrown when subset construction would create more DFA states than the caller allowed
+class DfaStateLimitExceeded : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
 };
 
 class DfaBuilder {
   public:
-    Dfa build(const Nfa& nfa) const;
+    // throws DfaStateLimitExceeded once more than maxStates states would be created
+    Dfa build(const Nfa& nfa, std::size_t maxStates = std::numeric_limits<std::size_t>::max()) const;
+    // Hopcroft partition refinement; returns the equivalent DFA with the fewest states
+    Dfa minimize(const Dfa& dfa) const;
+    // adds a table that consumes `stride` symbols per lookup; the stride is lowered until the table has at
+    // most kMaxStrideColumns columns and kMaxStrideTableBytes bytes, and the stride actually used is left in
+    // Dfa::stride (1 leaves the DFA unchanged)
+    Dfa withStride(const Dfa& dfa, std::size_t stride) const;
+
+    static constexpr std::size_t kMaxStrideColumns = 4096;
+    static constexpr std::size_t kMaxStrideTableBytes = std::size_t{16} << 20;
+};
+
+// Glushkov position automaton over at most 64 symbol positions (literals, classes and wildcards numbered left
+// to right); every set of positions is one bit mask
+struct Glushkov {
+    std::size_t positions{0};
+    std::uint64_t first{0};
+    std::uint64_t last{0};
+    bool nullable{false};
+    // symbols[c]: positions whose literal, class or wildcard accepts byte c
+    std::array<std::uint64_t, 256> symbols{};
+    // follow[p]: positions that may consume the symbol right after position p
+    std::vector<std::uint64_t> follow;
+    RequiredFactor required;
+};
+
+class GlushkovBuilder {
+  public:
+    static constexpr std::size_t kMaxPositions = 64;
+
+    explicit GlushkovBuilder(const RegexParser& parser);
+    // throws std::runtime_error when the pattern is invalid or has more than kMaxPositions positions
+    Glushkov build(const std::string& pattern) const;
+    // true when the pattern parses and has between 1 and kMaxPositions positions
+    bool fits(const std::string& pattern) const;
+
+  private:
+    const RegexParser& parser_;
+};
+
+// the EFA's consuming edges fused with the epsilon closure of their targets, one entry per (source, target)
+// pair, grouped by target in structure-of-arrays form for the vectorized EFA step. Entry i relaxes its target
+// with the cost of sources[i] plus mismatches[class * sources.size() + i], which is 0 when one of the fused
+// edges accepts the byte class and 1 otherwise.
+struct EfaEdgeLayout {
+    ByteClasses classes;
+    // entries targetOffsets[t] .. targetOffsets[t + 1] - 1 lead to state t
+    std::vector<std::size_t> targetOffsets;
+    std::vector<int> sources;
+    std::vector<std::uint8_t> mismatches;
+    // epsilon closure of the start state, all reached at cost 0
+    std::vector<int> startStates;
+    std::vector<std::uint8_t> accepting;
 };
 
 struct Efa {
+    // simulation keeps costs in a byte, with 255 marking unreachable states
+    static constexpr std::size_t kMaxMismatchBudget = 254;
+
     Nfa automaton;
     std::size_t mismatchBudget{0};
     std::string pattern;
+    // mismatchBudget + 1 disjoint literals of a fixed-length pattern; every match keeps one intact, so only
+    // starts lining one up need simulating. Empty when the pattern has none long enough to pay off.
+    std::vector<RequiredFactor> seeds;
+    EfaEdgeLayout layout;
+};
+
+// a plain concatenation of symbols as per-byte position masks for Myers' bit-parallel edit distance; 64
+// positions to a word and, unlike Glushkov, no cap on the length
+struct EditPattern {
+    std::size_t length{0};
+    std::size_t words{0};
+    // masks[byte * words + w]: bit i is set when position 64 * w + i accepts the byte
+    std::vector<std::uint64_t> masks;
+
+    bool accepts(std::size_t position, unsigned char symbol) const {
+        return (masks[symbol * words + position / 64] >> (position % 64)) & 1;
+    }
 };
 
 class EfaBuilder {
   public:
     explicit EfaBuilder(const RegexParser& parser);
     Efa build(const std::string& pattern, std::size_t mismatchBudget) const;
+    // determinize the (NFA state, mismatches) product: a DFA state is the set of NFA states reachable within the
+    // budget, each with its fewest mismatches. Running it like any DFA reports the EFA's intervals, and accepting
+    // states carry the fewest mismatches as the match distance. Throws DfaStateLimitExceeded past maxStates.
+    Dfa determinize(const Efa& efa, std::size_t maxStates) const;
+    // fused, class-resolved edge layout the vectorized EFA step runs over; build() fills Efa::layout with it
+    EfaEdgeLayout layoutEdges(const Nfa& nfa) const;
+    // position masks for --distance edit; throws for patterns with alternation or repetition
+    EditPattern buildEditPattern(const std::string& pattern) const;
+
+    // budgets above this are left to simulation; the product grows quickly with k
+    static constexpr std::size_t kMaxDeterminizedBudget = 2;
+    // shorter seeds hit so often on a four-letter alphabet that filtering loses to a plain scan
+    static constexpr std::size_t kMinSeedLength = 4;
 
   private:
     const RegexParser& parser_;
@@ -103,6 +254,11 @@ class PdaBuilder {
     Pda build(std::size_t maxDepth) const;
 };
 
+// NFA accepting the reversed language (edges flipped, accept states become the start)
+Nfa reverseNfa(const Nfa& nfa);
+// NFA for ".*" followed by the pattern, so a match may begin anywhere before the current position
+Nfa unanchoredNfa(const Nfa& nfa);
+
 // Helper to build PDA states up to a given max depth
 Pda buildPdaStates(std::size_t maxDepth);
 
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <variant>
 
 #include "AutomatonPlan.hpp"
 #include "IRunner.hpp"
 #include "automata/builders/Builders.hpp"
+#include "automata/utils/StateSet.hpp"
 
 namespace automata {
 
@@ -17,27 +22,275 @@ class NfaRunner : public IRunner {
 
   private:
     Nfa nfa_;
+    // the pattern run backwards from a match end; it accepts at nfa_.start, which marks where the match began
+    Nfa reversed_;
     bool trace_;
+    std::vector<int> startClosure_;
+    std::vector<int> reverseClosure_;
+    // scratch buffers reused across steps and runs so the simulation loop does not allocate; sized for the
+    // reversed NFA, which has one state more than nfa_
+    StateSet current_;
+    StateSet moved_;
+    StateSet reached_;
+    std::vector<std::size_t> ends_;
 };
 
 class DfaRunner : public IRunner {
   public:
     explicit DfaRunner(Dfa dfa, bool trace);
     RunResult run(const std::string& input) override;
+    // all-intervals scans of several inputs advance kBatchLanes of them in lockstep, so the table lookups of
+    // independent inputs overlap instead of forming one dependent chain
+    std::vector<RunResult> runBatch(const std::vector<std::string>& inputs) override;
+
+    static constexpr std::size_t kBatchLanes = 8;
+
+    // switch to leftmost-longest search: `forward` is the DFA of ".*" + pattern and `reverse` the DFA of
+    // ".*" + reversed pattern; the runner's own DFA then only extends matches from recovered starts
+    void setLeftmostLongest(Dfa forward, Dfa reverse) {
+        forward_ = std::move(forward);
+        reverse_ = std::move(reverse);
+        leftmostLongest_ = true;
+    }
 
   private:
+    RunResult runLeftmostLongest(const std::string& input);
+
     Dfa dfa_;
     bool trace_;
+    bool leftmostLongest_{false};
+    Dfa forward_;
+    Dfa reverse_;
+};
+
+// bit-parallel (Shift-And style) simulation of a Glushkov automaton: the live positions of every attempt share
+// one 64-bit mask, so a forward pass finds each offset where some match ends, and a backward pass over the
+// reversed automaton from each such end recovers the starts. Reports the same intervals as NfaRunner.
+class ShiftAndRunner : public IRunner {
+  public:
+    ShiftAndRunner(Glushkov automaton, bool trace);
+    RunResult run(const std::string& input) override;
+
+  private:
+    // union of the follow (or precede) sets of all positions in the mask, one table lookup per mask byte
+    std::uint64_t followOf(std::uint64_t positions) const;
+    std::uint64_t precedeOf(std::uint64_t positions) const;
+
+    Glushkov automaton_;
+    bool trace_;
+    std::size_t chunks_;
+    // chunks_ x 256 tables indexed by one byte of a position mask
+    std::vector<std::uint64_t> followTable_;
+    std::vector<std::uint64_t> precedeTable_;
+    std::vector<std::size_t> ends_;
+};
+
+// Wu-Manber k-mismatch search for patterns that are a plain chain of at most 64 positions (no alternation or
+// repetition): level j of the bit vectors holds the pattern prefixes matched with at most j substitutions, so
+// each input byte costs budget + 1 shift-and-or steps. A chain has one length m, so every match is [end - m, end).
+// Reports the same intervals as EfaRunner.
+class WuManberRunner : public IRunner {
+  public:
+    WuManberRunner(const Glushkov& automaton, std::size_t mismatchBudget, bool trace);
+    RunResult run(const std::string& input) override;
+
+    static bool fits(const Glushkov& automaton);
+
+  private:
+    std::size_t length_;
+    std::size_t budget_;
+    bool trace_;
+    std::uint64_t lengthMask_;
+    std::array<std::uint64_t, 256> symbols_;
+    // the pattern's required literal for exact searches, empty otherwise
+    RequiredFactor required_;
+    std::vector<std::uint64_t> levels_;
+};
+
+// Myers' bit-parallel edit distance, blocked 64 positions to a word: each input byte updates the vertical
+// deltas of one DP column per active block, and only blocks that can still hold a distance within the budget
+// are stepped (Ukkonen's cut-off). Reports one interval per end position whose best distance is within the
+// budget; its start comes from a small DP over that end's window, taking the longest span among the closest.
+class MyersRunner : public IRunner {
+  public:
+    MyersRunner(EditPattern pattern, std::size_t budget, bool trace);
+    RunResult run(const std::string& input) override;
+    // keep only the `limit` closest hits, shrinking the budget (and with it the active band) as they improve
+    void setReportLimit(std::size_t limit) { reportLimit_ = limit; }
+
+  private:
+    // the start of the closest alignment ending at `end` among those spanning at most `span` symbols; `whole`
+    // receives the distance of input[0, end) when the window reaches back to offset 0
+    std::size_t recoverStart(const std::string& input, std::size_t end, std::size_t span, std::size_t& whole);
+
+    EditPattern pattern_;
+    std::size_t budget_;
+    bool trace_;
+    std::size_t reportLimit_{0};
+    std::vector<std::uint64_t> pv_;
+    std::vector<std::uint64_t> mv_;
+    std::vector<std::size_t> scores_;
+    // start recovery: masks of the reversed pattern and the backward pass's bit vectors
+    std::vector<std::uint64_t> reversedMasks_;
+    std::vector<std::uint64_t> backPv_;
+    std::vector<std::uint64_t> backMv_;
 };
 
+// steps DFAs with fewer than kLanes states (the dead state takes the last slot) using byte shuffles: every
+// input byte selects a 16-entry "next state" vector, and one shuffle advances kLanes match attempts that begin
+// at consecutive offsets. Uses SSSE3 pshufb when the CPU has it and an equivalent scalar loop otherwise; the
+// result is identical to DfaRunner's all-intervals scan.
+class ShuffleDfaRunner : public IRunner {
+  public:
+    static constexpr std::size_t kLanes = 16;
+
+    explicit ShuffleDfaRunner(const Dfa& dfa);
+    // keeps IRunner's sequential runBatch; RunnerFactory only picks it for a single input
+    RunResult run(const std::string& input) override;
+
+    static bool fits(const Dfa& dfa) { return !dfa.states.empty() && dfa.states.size() < kLanes; }
+    bool vectorized() const { return vectorized_; }
+    // step lanes with the table loop even when the CPU has SSSE3, so tests can cover both kernels on one machine
+    void useScalarKernel() {
+        kernel_ = &ShuffleDfaRunner::scanBlockScalar;
+        vectorized_ = false;
+    }
+
+  private:
+    // scanBlock* put lane t in the start state at input[t] for each bit t of `candidates` and step until every
+    // lane is dead with none left to start, returning the bytes stepped. Each byte appends 1 + distanceBits_
+    // masks: the lanes in an accepting state after it, then bit b of their states' mismatches for each b.
+    // `visited` counts live lane steps, which equals DfaRunner's statesVisited
+    using Kernel = std::size_t (ShuffleDfaRunner::*)(const unsigned char*, std::size_t, unsigned,
+                                                     std::vector<std::uint16_t>&, std::size_t&) const;
+    std::size_t scanBlockScalar(const unsigned char* input, std::size_t length, unsigned candidates,
+                                std::vector<std::uint16_t>& acceptMasks, std::size_t& visited) const;
+    std::size_t scanBlockSsse3(const unsigned char* input, std::size_t length, unsigned candidates,
+                               std::vector<std::uint16_t>& acceptMasks, std::size_t& visited) const;
+
+    std::uint8_t start_{0};
+    std::uint8_t dead_{0};
+    bool startAccepts_{false};
+    RequiredFactor required_;
+    bool vectorized_{false};
+    Kernel kernel_;
+    // shuffles_[byte][state] is the successor of `state` on `byte`; accepting_[state] is 0xFF for accept states
+    alignas(16) std::array<std::array<std::uint8_t, kLanes>, 256> shuffles_{};
+    alignas(16) std::array<std::uint8_t, kLanes> accepting_{};
+    // determinized EFAs (Dfa::reportsMismatches): distancePlanes_[b][state] is 0xFF when bit b of the state's
+    // mismatches is set; costs stay below 255, so eight planes always suffice
+    bool reportsMismatches_{false};
+    std::size_t startMismatches_{0};
+    std::size_t distanceBits_{0};
+    alignas(16) std::array<std::array<std::uint8_t, kLanes>, 8> distancePlanes_{};
+    std::vector<std::uint16_t> acceptMasks_;
+    std::vector<std::tuple<std::size_t, std::size_t, std::size_t>> hits_;
+};
+
+// builds DFA states only as the input reaches them and caches them (with their transitions) up to a memory
+// budget. When the budget is exceeded the cache is flushed; if that keeps happening within one run the runner
+// gives up on caching and falls back to NFA simulation.
+class LazyDfaRunner : public IRunner {
+  public:
+    LazyDfaRunner(Nfa nfa, std::size_t cacheBudget, bool trace);
+    RunResult run(const std::string& input) override;
+    // reduce the reported intervals to non-overlapping leftmost-longest matches, like DfaRunner's search mode
+    void setLeftmostLongest() { leftmostLongest_ = true; }
+    std::size_t cachedStates() const { return states_.size(); }
+    std::size_t cacheFlushes() const { return flushes_; }
+
+  private:
+    struct CachedState {
+        std::vector<int> subset;
+        bool accept{false};
+    };
+
+    RunResult scan(const std::string& input);
+    int intern(const std::vector<int>& subset);
+    int step(int state, unsigned char symbol);
+    void flush();
+
+    Nfa nfa_;
+    std::size_t cacheBudget_;
+    bool trace_;
+    bool leftmostLongest_{false};
+    ByteClasses classes_;
+    std::vector<CachedState> states_;
+    // states_.size() x classes_.count table; kUnknown marks transitions that have not been determinized yet
+    std::vector<int> transitions_;
+    std::unordered_map<std::vector<int>, int, SubsetHash> subsetToId_;
+    std::size_t cacheBytes_{0};
+    std::size_t flushes_{0};
+    std::vector<int> subset_;
+    StateSet moved_;
+    StateSet reached_;
+};
+
+// Untraced, unranked, unseeded scans run kLanes attempts that begin at consecutive offsets side by side: one byte of
+// cost per (state, lane), stepped as a min-plus relaxation over Efa::layout with AVX2 when the CPU has it and
+// an equivalent scalar loop otherwise. Traces and ranked reports use the per-attempt thread simulation.
 class EfaRunner : public IRunner {
   public:
+    static constexpr std::size_t kLanes = 32;
+
     explicit EfaRunner(Efa efa, bool trace);
     RunResult run(const std::string& input) override;
+    // keep only the `limit` cheapest hits; the working budget drops below the worst kept hit once there are
+    // `limit` of them, so states that could only produce worse hits are pruned
+    void setReportLimit(std::size_t limit) { reportLimit_ = limit; }
+    bool vectorized() const { return vectorized_; }
+    // run the portable lane loop even when the CPU has AVX2, so tests can cover both kernels on one machine
+    void useScalarKernel() {
+        kernel_ = &EfaRunner::scanLanesScalar;
+        vectorized_ = false;
+    }
 
   private:
+    // budgets are capped at Efa::kMaxMismatchBudget, so a byte holds any cost and 255 marks "not reached"
+    using Cost = std::uint8_t;
+    static constexpr Cost kUnreachable = 255;
+
+    // scanLanes* give the start states of lane t cost 0 at input[t] for each bit t of `candidates`, step until
+    // no lane is within budget or left to start, and return the bytes stepped. acceptMasks[t] lists the lanes
+    // at an accepting state within budget after byte t; `visited` counts the (state, lane) cells within budget,
+    // the threads the simulation would have stepped
+    using Kernel = std::size_t (EfaRunner::*)(const unsigned char*, std::size_t, std::uint32_t,
+                                              std::vector<std::uint32_t>&, std::size_t&);
+    std::size_t scanLanesScalar(const unsigned char* input, std::size_t length, std::uint32_t candidates,
+                                std::vector<std::uint32_t>& acceptMasks, std::size_t& visited);
+    std::size_t scanLanesAvx2(const unsigned char* input, std::size_t length, std::uint32_t candidates,
+                              std::vector<std::uint32_t>& acceptMasks, std::size_t& visited);
+    RunResult runLanes(const std::string& input);
+
+    // one (state, mismatch cost) pair of the match attempt that began at `start`
+    struct Thread {
+        int state;
+        Cost cost;
+        std::size_t start;
+    };
+
+    // extends costs_ over epsilon edges from the states in touched_, adding newly reached states to touched_
+    void closeWithCosts(const Nfa& nfa);
+
     Efa efa_;
     bool trace_;
+    std::size_t reportLimit_{0};
+    // scratch buffers reused across steps and runs so the simulation loop does not allocate. current_/next_
+    // are the double-buffered active lists; costs_ is kUnreachable everywhere between steps, and touched_ lists
+    // the states a step reached so only those are read back and reset
+    std::vector<Thread> current_;
+    std::vector<Thread> next_;
+    std::vector<Thread> startThreads_;
+    std::vector<Cost> costs_;
+    std::vector<int> touched_;
+    std::vector<int> queue_;
+    std::vector<bool> inQueue_;
+    // lane kernels: the (state x kLanes) cost matrix before and after a byte, and per-byte accept masks
+    bool vectorized_{false};
+    Kernel kernel_;
+    std::vector<Cost> laneCosts_;
+    std::vector<Cost> nextLaneCosts_;
+    std::vector<std::uint32_t> acceptMasks_;
 };
 
 class PdaRunner : public IRunner {
@@ -52,6 +305,8 @@ class PdaRunner : public IRunner {
   private:
     Pda pda_;
     bool trace_;
+    // the PDA is buildPdaStates' bracket machine, so DotBracketValidator::scan can stand in for the loop
+    bool bracketsOnly_{false};
     std::string rnaSecondary_;
 };
 
@@ -60,6 +315,13 @@ class RunnerFactory {
     struct Snapshot {
         AutomatonKind kind{AutomatonKind::Nfa};
         std::variant<Nfa, Dfa, Efa, Pda> automaton;
+        // DFA size straight out of subset construction and after minimization (equal when not minimized)
+        std::size_t rawDfaStates{0};
+        std::size_t dfaStates{0};
+        // why the requested automaton was replaced by another engine (empty when it was not)
+        std::string fallbackReason;
+        // DFA scan kernel picked for the run ("table", "shuffle (SSSE3)" or "shuffle (scalar)")
+        std::string dfaKernel;
     };
 
     RunnerPtr create(const AutomatonPlan& plan, const RegexParser& parser, Snapshot* snapshot = nullptr) const;
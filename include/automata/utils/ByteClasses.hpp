@@ -0,0 +1,11 @@
+#pragma once
+
+#include "automata/builders/Builders.hpp"
+
+namespace automata {
+
+// partition the 256 byte values so that bytes no literal, character class or wildcard edge of the NFA can tell
+// apart share a class; automata built over the classes behave exactly like ones built over raw bytes
+ByteClasses computeByteClasses(const Nfa& nfa);
+
+}  // namespace automata
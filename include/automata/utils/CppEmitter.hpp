@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+#include "automata/builders/Builders.hpp"
+
+namespace automata {
+
+// render `dfa` as a self-contained C++17 header: a byte-class table plus a goto-based state machine whose
+// scan() reports the same [start, end) intervals as DfaRunner's all-intervals mode
+std::string emitCppScanner(const Dfa& dfa, const std::string& pattern);
+
+}  // namespace automata
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "automata/builders/Builders.hpp"
+
+namespace automata {
+
+// pick the most selective literal that every match of the postfix pattern must contain (longest first, then the
+// narrowest offset window); returns an empty factor when no literal is mandatory
+RequiredFactor extractRequiredFactor(const std::vector<RegexToken>& postfix);
+
+// for a fixed-length pattern (a plain concatenation of symbols), split its literal runs into `pieces` disjoint
+// literals at fixed offsets, as long as the shortest allows. A match with fewer than `pieces` substitutions
+// leaves at least one of them intact. Returns no seeds for other patterns or when too few literal symbols exist.
+std::vector<RequiredFactor> extractSeeds(const std::vector<RegexToken>& postfix, std::size_t pieces);
+
+// walks the start offsets of one input that can begin a match: a start s is a candidate when the required
+// literal occurs at s + offset for an offset inside the factor's window. Queries must be non-decreasing so the
+// last literal hit can be reused.
+class CandidateScanner {
+  public:
+    CandidateScanner(const RequiredFactor& factor, std::string_view input);
+
+    // smallest candidate start >= from, or npos when no later offset can start a match
+    std::size_t next(std::size_t from);
+
+    static constexpr std::size_t npos = std::string_view::npos;
+
+  private:
+    std::size_t find(std::size_t from) const;
+
+    const RequiredFactor* factor_;
+    std::string_view input_;
+    // first literal occurrence at or after the last searched offset (npos when there is none)
+    std::size_t hit_{npos};
+    bool searched_{false};
+};
+
+// the start offsets where at least one seed lines up with the input: one CandidateScanner per seed, merged.
+// Same contract as CandidateScanner; no seeds means every offset is a candidate.
+class SeedScanner {
+  public:
+    SeedScanner(const std::vector<RequiredFactor>& seeds, std::string_view input);
+
+    std::size_t next(std::size_t from);
+
+    static constexpr std::size_t npos = CandidateScanner::npos;
+
+  private:
+    std::size_t size_;
+    std::vector<CandidateScanner> scanners_;
+};
+
+}  // namespace automata
@@ -1,25 +1,53 @@
 #pragma once
 
-#include <unordered_set>
+#include <cstddef>
 #include <vector>
 
 #include "automata/builders/Builders.hpp"
 
 namespace automata {
 
+// sparse set over NFA state ids: a dense member list plus a sparse index into it, so membership tests and
+// clear() are O(1) and a set owned by a runner can be reused for every step without touching the heap
 class StateSet {
   public:
+    StateSet() = default;
     explicit StateSet(std::size_t size);
     void add(int state);
     bool contains(int state) const;
+    void clear() { values_.clear(); }
+    bool empty() const { return values_.empty(); }
+    std::size_t size() const { return values_.size(); }
     const std::vector<int>& values() const { return values_; }
 
   private:
     std::vector<int> values_;
-    std::vector<bool> visited_;
+    std::vector<int> sparse_;
 };
 
+// hash for sorted state-id vectors, so subsets can key an unordered_map directly
+struct SubsetHash {
+    std::size_t operator()(const std::vector<int>& subset) const {
+        std::size_t hash = subset.size();
+        for (int state : subset) {
+            hash ^= static_cast<std::size_t>(state) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+// literal, class and wildcard edges consume a byte; epsilon edges never do
+bool consumesSymbol(EdgeType type);
+// does the edge consume this byte; the DFA table, the EFA edge layout and the EFA simulation all go through it
+bool edgeAccepts(const Edge& edge, char symbol);
+
+// fills nfa.closureOffsets/closureStates so epsilonClosure can union precomputed sets instead of searching
+void computeEpsilonClosures(Nfa& nfa);
 std::vector<int> epsilonClosure(const Nfa& nfa, const std::vector<int>& states);
 std::vector<int> move(const Nfa& nfa, const std::vector<int>& states, char symbol);
 
+// allocation-free variants: clear `out` and write the result into it (out must be sized for the NFA)
+void epsilonClosure(const Nfa& nfa, const std::vector<int>& states, StateSet& out);
+void move(const Nfa& nfa, const std::vector<int>& states, char symbol, StateSet& out);
+
 }  // namespace automata
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <queue>
+#include <tuple>
+
+#include "IRunner.hpp"
+
+namespace automata {
+
+// keeps the `limit` cheapest approximate hits of one run, preferring the earlier-found hit on equal cost, and
+// tells the engine the largest cost a new hit may still have to get in. Once it is full, that bound drops
+// below its worst hit, so engines can prune every state that could only produce a worse one.
+class TopHits {
+  public:
+    TopHits(std::size_t limit, std::size_t budget);
+
+    void add(std::size_t start, std::size_t end, std::size_t cost);
+    // largest cost a new hit can have and still be kept; meaningless once closed()
+    std::size_t budget() const { return budget_; }
+    // full of zero-cost hits: nothing found later can get in, so the scan can stop
+    bool closed() const { return closed_; }
+    // writes the kept hits to result.matches / result.distances, cheapest first, ties by position
+    void finish(RunResult& result);
+
+  private:
+    // (cost, discovery order, start, end): the heap top is the hit to evict next
+    using Hit = std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>;
+
+    std::size_t limit_;
+    std::size_t budget_;
+    bool closed_{false};
+    std::size_t found_{0};
+    std::priority_queue<Hit> kept_;
+};
+
+}  // namespace automata
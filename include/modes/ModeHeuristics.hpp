@@ -1,9 +1,13 @@
 #pragma once
 
 #include <cstddef>
+#include <string>
 
 namespace automata {
 
 bool shouldDeterminize(std::size_t patternLength, std::size_t inputLength);
 
+// true when the regex can run on the bit-parallel Shift-And engine (see GlushkovBuilder::fits)
+bool fitsShiftAnd(const std::string& pattern);
+
 }  // namespace automata
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -23,10 +25,54 @@ class DatasetLoader {
     std::vector<std::string> loadSequences(const std::string& path) const;
 };
 
+// result of one pass over a dot-bracket structure, up to the first position that breaks it
+struct DotBracketScan {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    // nesting depth after the scanned prefix, and the deepest it got
+    std::size_t depth{0};
+    std::size_t maxDepth{0};
+    // first ')' without a partner, first '(' past the depth limit, or (when strict) first byte other than
+    // '(', ')' and '.'; npos when the whole structure was scanned
+    std::size_t stop{npos};
+};
+
+// a chunk of a structure on its own: net depth change and the lowest/highest depth (the empty prefix included)
+// relative to the chunk's start, plus its first byte other than '(', ')' and '.'
+struct DotBracketSummary {
+    std::size_t length{0};
+    std::ptrdiff_t delta{0};
+    std::ptrdiff_t minPrefix{0};
+    std::ptrdiff_t maxPrefix{0};
+    std::size_t foreign{DotBracketScan::npos};
+};
+
+// summary of `left` followed by `right`; associative, so chunks can be summarized in any grouping
+DotBracketSummary combineSummaries(const DotBracketSummary& left, const DotBracketSummary& right);
+
 class DotBracketValidator {
   public:
     bool validate(const std::string& sequence) const;
     std::size_t getMaxDepth(const std::string& sequence) const;
+    // structures this long are split across the hardware threads, at least kMinChunk bytes to each
+    static constexpr std::size_t kParallelThreshold = std::size_t{8} << 20;
+    static constexpr std::size_t kMinChunk = std::size_t{1} << 20;
+
+    // validity, depth and first error in one pass: classifies bytes into +1/-1/0 and checks the prefix sums
+    // 32 at a time with AVX2 when the CPU has it, otherwise a byte at a time
+    DotBracketScan scan(std::string_view structure, bool strict = true,
+                        std::size_t depthLimit = DotBracketScan::npos) const;
+    // the same result from `threads` workers: each summarizes one chunk, the summaries are scanned for the chunk
+    // depths start at, and only the first chunk that can break the structure is walked again to find where
+    DotBracketScan scanChunked(std::string_view structure, std::size_t threads, bool strict = true,
+                               std::size_t depthLimit = DotBracketScan::npos) const;
+    DotBracketSummary summarize(std::string_view chunk) const;
+    // position of the first error, the structure's length when brackets are left open, npos when it is valid
+    std::size_t firstError(std::string_view structure) const;
+    // use the byte-at-a-time loops even when the CPU has AVX2, so tests can cover both kernels on one machine
+    void useScalarKernel() { scalar_ = true; }
+
+  private:
+    bool scalar_{false};
 };
 
 }  // namespace automata
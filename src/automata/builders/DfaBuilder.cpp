@@ -1,130 +1,108 @@
 #include "automata/builders/Builders.hpp"
 
 #include <algorithm>
-#include <array>
+#include <map>
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
+#include "automata/utils/ByteClasses.hpp"
 #include "automata/utils/StateSet.hpp"
 
 namespace automata {
-namespace {
 
-// sorting then removing duplicates on the end side
-std::vector<int> normalize(std::vector<int> states) {
-    std::sort(states.begin(), states.end());
-    states.erase(std::unique(states.begin(), states.end()), states.end());
-    return states;
-}
+Dfa DfaBuilder::build(const Nfa& nfa, std::size_t maxStates) const {
+    Dfa dfa;
+    dfa.required = nfa.required;
+    // only bytes the NFA can tell apart need their own column in the table
+    dfa.classes = computeByteClasses(nfa);
+    const auto classCount = dfa.classes.count;
 
-// like converting the vector in to a string with commas delimit
-std::string makeKey(const std::vector<int>& states) {
-    std::string key;
-    for (int s : states) {
-        key.append(std::to_string(s));
-        key.push_back(',');
+    // per NFA state, the (class, target) pairs its consuming edges allow, in CSR form; resolving edges against
+    // classes once up front means subsets never re-test literals or scan character-class strings
+    std::vector<std::size_t> stepOffsets(1, 0);
+    std::vector<std::pair<std::size_t, int>> steps;
+    for (const auto& state : nfa.states) {
+        for (const auto& edge : state.edges) {
+            for (std::size_t k = 0; k < classCount; ++k) {
+                if (edgeAccepts(edge, static_cast<char>(dfa.classes.representatives[k]))) {
+                    steps.emplace_back(k, edge.to);
+                }
+            }
+        }
+        stepOffsets.push_back(steps.size());
     }
-    return key;
-}
-
-}  // namespace
 
-Dfa DfaBuilder::build(const Nfa& nfa) const {
-    Dfa dfa;
     std::vector<DfaState> dfaStates;
-    // each unique subset of NFA states gets assigned a unique ID
-    std::unordered_map<std::string, int> subsetToId;
-    // todo list of subsets that need to be processed
-    std::queue<std::vector<int>> pending;
+    // each unique subset of NFA states (sorted) gets assigned a unique ID; subsets[id] keeps it for expansion
+    std::unordered_map<std::vector<int>, int, SubsetHash> subsetToId;
+    std::vector<std::vector<int>> subsets;
+    // todo list of DFA states whose transitions still need to be computed
+    std::queue<int> pending;
 
-    // epsilon closure = find all states reachable from start state by epsilon
-    auto startClosure = normalize(epsilonClosure(nfa, {nfa.start}));
-
-    // string rep
-    auto startKey = makeKey(startClosure);
-    
-    // first nfa subset is 0
-    subsetToId[startKey] = 0;
-    // add first subset to queue
-    pending.push(startClosure);
-
-    // append new dfa state , assures each unique set of NFA state gets its own corresponding dfa state in order.
-    // we add new dfa state when we encounter a new subset of NFA states that hasnt been represented yet
-    dfaStates.push_back(DfaState{});
-
-    // initial set of all transition to -1
-    dfaStates[0].next.fill(-1);
-
-    // go through each state in start closure
-    for (int s : startClosure) {
-        if (nfa.states[s].accept) {
-            // if any of the states in the start closure are accepting, set the accepting flag for the first dfa state
-            dfaStates[0].accept = true;
-            break;
+    StateSet closure(nfa.states.size());
+    // register a sorted subset, returning its id and creating the DFA state on first sight
+    auto intern = [&](std::vector<int> subset) {
+        auto it = subsetToId.find(subset);
+        if (it != subsetToId.end()) {
+            return it->second;
         }
-    }
+        // stop before a pathological pattern exhausts memory; callers decide how to fall back
+        if (dfaStates.size() >= maxStates) {
+            throw DfaStateLimitExceeded("DFA construction exceeded the limit of " + std::to_string(maxStates) +
+                                        " states");
+        }
+        const int id = static_cast<int>(dfaStates.size());
+        DfaState state{};
+        // if any of the nfa state is accepting, then the whole dfa state is accepting
+        for (int s : subset) {
+            if (nfa.states[s].accept) {
+                state.accept = true;
+                break;
+            }
+        }
+        dfaStates.push_back(state);
+        // initial set of all transition to -1
+        dfa.transitions.resize(dfa.transitions.size() + classCount, -1);
+        subsetToId.emplace(subset, id);
+        subsets.push_back(std::move(subset));
+        pending.push(id);
+        return id;
+    };
 
+    // epsilon closure = find all states reachable from start state by epsilon
+    epsilonClosure(nfa, {nfa.start}, closure);
+    auto startSubset = closure.values();
+    std::sort(startSubset.begin(), startSubset.end());
+    intern(std::move(startSubset));
+
+    // targets reached per class from the current subset; only classes some member can consume are touched
+    std::vector<std::vector<int>> buckets(classCount);
+    std::vector<std::size_t> touched;
     while (!pending.empty()) {
-        auto currentStates = pending.front();
-        // remove front subset from queue
+        const int currentId = pending.front();
         pending.pop();
-        int currentId = subsetToId[makeKey(currentStates)];
-        
-        
-        for (int c = 0; c < 256; ++c) {
-            // which nfa states we reach from the current set of NFA states were in
-            auto moved = move(nfa, currentStates, static_cast<char>(c));
-            if (moved.empty()) {
-                continue;
-            }
-            // epsilon closure = find all states reachable from the current set of NFA states by epsilon
-            auto closure = normalize(epsilonClosure(nfa, moved));
-            // if the epsilon closure is empty, there are no reachable states from the current set of NFA states by epsilon
-            if (closure.empty()) {
-                continue;
-            }
-            
-            // string rep
-            auto key = makeKey(closure);
-            
-            int targetId = 0;
-            auto it = subsetToId.find(key);
-
-            // if the key is not existing, then it = subsetToId.end()
-            if (it == subsetToId.end()) {
-                targetId = static_cast<int>(dfaStates.size());
-
-                // add new NFA subset to subsetToId
-                subsetToId[key] = targetId;
-
-                // add new NFA subset to queue
-                pending.push(closure);
-
-                // append new dfa state
-                DfaState state{};
-
-                // initial set of all transition to -1
-                state.next.fill(-1);
-                for (int s : closure) {
-
-                    // if any of the states in the NFA subset are accepting, set the accepting flag for the new dfa state
-                    // if any of the nfa state is accepting, then the whole dfa state is accepting
-                    if (nfa.states[s].accept) {
-                        state.accept = true;
-                        break;
-                    }
+        touched.clear();
+        for (int s : subsets[currentId]) {
+            for (auto i = stepOffsets[s]; i < stepOffsets[s + 1]; ++i) {
+                auto& bucket = buckets[steps[i].first];
+                if (bucket.empty()) {
+                    touched.push_back(steps[i].first);
                 }
-                dfaStates.push_back(state);
-            } else {
-                // if the key is existing, then it = subsetToId.find(key)
-                // it->second = the id of the NFA subset
-                targetId = it->second;
+                bucket.push_back(steps[i].second);
             }
-
+        }
+        // ascending class order keeps state numbering independent of edge order
+        std::sort(touched.begin(), touched.end());
+        for (auto k : touched) {
+            epsilonClosure(nfa, buckets[k], closure);
+            buckets[k].clear();
+            auto subset = closure.values();
+            std::sort(subset.begin(), subset.end());
+            const int targetId = intern(std::move(subset));
             // set the transition for the current dfa state to the target dfa state
-            // next = transition
-            dfaStates[currentId].next[c] = targetId;
+            dfa.transitions[static_cast<std::size_t>(currentId) * classCount + k] = targetId;
         }
     }
 
@@ -136,4 +114,221 @@ Dfa DfaBuilder::build(const Nfa& nfa) const {
     return dfa;
 }
 
+Dfa DfaBuilder::minimize(const Dfa& dfa) const {
+    const auto count = dfa.states.size();
+    if (count == 0) {
+        return dfa;
+    }
+    // complete the automaton with an explicit dead state (id = count) so every state has a transition per class
+    const int dead = static_cast<int>(count);
+    const auto total = count + 1;
+    const int symbols = static_cast<int>(dfa.classes.count);
+    auto target = [&](std::size_t state, int c) {
+        if (state == count) {
+            return dead;
+        }
+        const int next = dfa.transitions[state * dfa.classes.count + c];
+        return next < 0 ? dead : next;
+    };
+
+    // inverse transitions per class in CSR form: predecessors of t on c are
+    // inverse[offsets[c * total + t]] .. inverse[offsets[c * total + t + 1] - 1]
+    std::vector<std::size_t> offsets(symbols * total + 1, 0);
+    for (std::size_t s = 0; s < total; ++s) {
+        for (int c = 0; c < symbols; ++c) {
+            ++offsets[c * total + target(s, c) + 1];
+        }
+    }
+    for (std::size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+    std::vector<int> inverse(offsets.back());
+    {
+        auto fill = offsets;
+        for (std::size_t s = 0; s < total; ++s) {
+            for (int c = 0; c < symbols; ++c) {
+                inverse[fill[c * total + target(s, c)]++] = static_cast<int>(s);
+            }
+        }
+    }
+
+    // initial partition: accepting vs non-accepting (the dead state is non-accepting); accepting states are
+    // further split by their mismatch annotation so k-mismatch DFAs keep it
+    std::vector<std::vector<int>> blocks(1);
+    std::vector<int> blockOf(total, 0);
+    {
+        std::map<std::size_t, int> acceptingBlock;
+        for (std::size_t s = 0; s < total; ++s) {
+            if (s < count && dfa.states[s].accept) {
+                auto [it, inserted] =
+                    acceptingBlock.try_emplace(dfa.states[s].mismatches, static_cast<int>(blocks.size()));
+                if (inserted) {
+                    blocks.emplace_back();
+                }
+                blockOf[s] = it->second;
+                blocks[it->second].push_back(static_cast<int>(s));
+            } else {
+                blocks[0].push_back(static_cast<int>(s));
+            }
+        }
+    }
+    std::vector<int> worklist;
+    std::vector<bool> inWorklist(blocks.size(), true);
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        worklist.push_back(static_cast<int>(b));
+    }
+
+    // refine until no block can be split by the predecessors of a splitter
+    std::vector<int> hits(total, 0);
+    std::vector<int> touched;
+    std::vector<int> marked;
+    std::vector<bool> isMarked(total, false);
+    while (!worklist.empty()) {
+        const int splitter = worklist.back();
+        worklist.pop_back();
+        inWorklist[splitter] = false;
+        const auto members = blocks[splitter];
+        for (int c = 0; c < symbols; ++c) {
+            // X = states whose transition on c lands in the splitter
+            marked.clear();
+            touched.clear();
+            for (int t : members) {
+                for (auto i = offsets[c * total + t]; i < offsets[c * total + t + 1]; ++i) {
+                    const int s = inverse[i];
+                    if (isMarked[s]) {
+                        continue;
+                    }
+                    isMarked[s] = true;
+                    marked.push_back(s);
+                    if (hits[blockOf[s]]++ == 0) {
+                        touched.push_back(blockOf[s]);
+                    }
+                }
+            }
+            for (int b : touched) {
+                // blocks entirely inside X are not split
+                if (static_cast<std::size_t>(hits[b]) < blocks[b].size()) {
+                    std::vector<int> inside;
+                    std::vector<int> outside;
+                    for (int s : blocks[b]) {
+                        (isMarked[s] ? inside : outside).push_back(s);
+                    }
+                    const int fresh = static_cast<int>(blocks.size());
+                    for (int s : inside) {
+                        blockOf[s] = fresh;
+                    }
+                    blocks[b] = std::move(outside);
+                    blocks.push_back(std::move(inside));
+                    inWorklist.push_back(false);
+                    // a pending block must be refined by both halves; otherwise the smaller half suffices
+                    if (inWorklist[b] || blocks[fresh].size() <= blocks[b].size()) {
+                        worklist.push_back(fresh);
+                        inWorklist[fresh] = true;
+                    } else {
+                        worklist.push_back(b);
+                        inWorklist[b] = true;
+                    }
+                }
+                hits[b] = 0;
+            }
+            for (int s : marked) {
+                isMarked[s] = false;
+            }
+        }
+    }
+
+    // renumber the surviving blocks in breadth-first order from the start block, dropping the dead block
+    const int deadBlock = blockOf[dead];
+    std::vector<int> newId(blocks.size(), -1);
+    std::vector<int> order;
+    newId[blockOf[dfa.start]] = 0;
+    order.push_back(blockOf[dfa.start]);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const int representative = blocks[order[i]].front();
+        for (int c = 0; c < symbols; ++c) {
+            const int b = blockOf[target(representative, c)];
+            if (b != deadBlock && newId[b] < 0) {
+                newId[b] = static_cast<int>(order.size());
+                order.push_back(b);
+            }
+        }
+    }
+
+    Dfa minimized;
+    minimized.start = 0;
+    minimized.classes = dfa.classes;
+    minimized.required = dfa.required;
+    minimized.reportsMismatches = dfa.reportsMismatches;
+    minimized.states.resize(order.size());
+    minimized.transitions.assign(order.size() * dfa.classes.count, -1);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const int representative = blocks[order[i]].front();
+        minimized.states[i].accept = representative != dead && dfa.states[representative].accept;
+        minimized.states[i].mismatches = representative != dead ? dfa.states[representative].mismatches : 0;
+        for (int c = 0; c < symbols; ++c) {
+            const int b = blockOf[target(representative, c)];
+            minimized.transitions[i * dfa.classes.count + c] = b == deadBlock ? -1 : newId[b];
+        }
+    }
+    return minimized;
+}
+
+Dfa DfaBuilder::withStride(const Dfa& dfa, std::size_t stride) const {
+    const auto classCount = dfa.classes.count;
+    // the accept mask has one bit per symbol
+    stride = std::min<std::size_t>(stride, 8);
+    // both products saturate just past their cap, so 256 classes at stride 8 cannot wrap around to zero
+    auto columnsFor = [classCount](std::size_t k) {
+        std::size_t columns = 1;
+        for (std::size_t i = 0; i < k && columns <= kMaxStrideColumns; ++i) {
+            columns *= classCount;
+        }
+        return std::min(columns, kMaxStrideColumns + 1);
+    };
+    auto tableFits = [&](std::size_t columns) {
+        const auto rowBytes = columns * sizeof(DfaStrideStep);
+        return rowBytes == 0 || dfa.states.size() <= kMaxStrideTableBytes / rowBytes;
+    };
+    while (stride > 1 && (columnsFor(stride) > kMaxStrideColumns || !tableFits(columnsFor(stride)))) {
+        --stride;
+    }
+    Dfa strided = dfa;
+    strided.stride = 1;
+    strided.strided.clear();
+    strided.strideColumns = 0;
+    if (stride <= 1 || dfa.states.empty()) {
+        return strided;
+    }
+    const auto columns = columnsFor(stride);
+    strided.stride = stride;
+    strided.strideColumns = columns;
+    strided.strided.resize(dfa.states.size() * columns);
+    std::vector<std::size_t> digits(stride);
+    for (std::size_t state = 0; state < dfa.states.size(); ++state) {
+        for (std::size_t column = 0; column < columns; ++column) {
+            // decode the column into its per-symbol classes, first symbol most significant
+            auto rest = column;
+            for (std::size_t i = stride; i-- > 0;) {
+                digits[i] = rest % classCount;
+                rest /= classCount;
+            }
+            DfaStrideStep step;
+            int current = static_cast<int>(state);
+            for (std::size_t i = 0; i < stride; ++i) {
+                current = dfa.transitions[static_cast<std::size_t>(current) * classCount + digits[i]];
+                if (current < 0) {
+                    break;
+                }
+                ++step.consumed;
+                if (dfa.states[current].accept) {
+                    step.acceptMask |= static_cast<std::uint8_t>(1u << i);
+                }
+            }
+            step.to = current;
+            strided.strided[state * columns + column] = step;
+        }
+    }
+    return strided;
+}
+
 }  // namespace automata
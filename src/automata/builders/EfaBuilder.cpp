@@ -1,6 +1,18 @@
 #include "automata/builders/Builders.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <queue>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "automata/utils/ByteClasses.hpp"
+#include "automata/utils/RequiredFactor.hpp"
+#include "automata/utils/StateSet.hpp"
 
 namespace automata {
 
@@ -10,6 +22,9 @@ Efa EfaBuilder::build(const std::string& pattern, std::size_t mismatchBudget) co
     if (pattern.empty()) {
         throw std::runtime_error("Approximate matching requires a non-empty pattern.");
     }
+    if (mismatchBudget > Efa::kMaxMismatchBudget) {
+        throw std::runtime_error("Mismatch budget must not exceed " + std::to_string(Efa::kMaxMismatchBudget) + ".");
+    }
 
     // create Nfabuilder object then pass regex parser from the Efabuilder
     // RegexParser -> EfaBuilder(parser) -> NfaBuilder(parser)
@@ -20,7 +35,233 @@ Efa EfaBuilder::build(const std::string& pattern, std::size_t mismatchBudget) co
 
     // Efa constructor
     // std::move(nfa) = make nfa into an r-value expression (temporary) since nfa is a BIG object
-    return Efa{std::move(nfa), mismatchBudget, pattern};
+    Efa efa{std::move(nfa), mismatchBudget, pattern, {}, {}};
+
+    // pigeonhole seeds; exact searches already filter on the required literal
+    if (mismatchBudget > 0) {
+        auto seeds = extractSeeds(parser_.parseToPostfix(pattern), mismatchBudget + 1);
+        const bool longEnough = std::all_of(seeds.begin(), seeds.end(), [](const RequiredFactor& seed) {
+            return seed.literal.size() >= kMinSeedLength;
+        });
+        if (longEnough) {
+            efa.seeds = std::move(seeds);
+        }
+    }
+    efa.layout = layoutEdges(efa.automaton);
+    return efa;
+}
+
+EfaEdgeLayout EfaBuilder::layoutEdges(const Nfa& nfa) const {
+    EfaEdgeLayout layout;
+    layout.classes = computeByteClasses(nfa);
+    const auto classCount = layout.classes.count;
+    const auto stateCount = nfa.states.size();
+
+    StateSet closure(stateCount);
+    epsilonClosure(nfa, {nfa.start}, closure);
+    layout.startStates = closure.values();
+    std::sort(layout.startStates.begin(), layout.startStates.end());
+    layout.accepting.resize(stateCount);
+    for (std::size_t s = 0; s < stateCount; ++s) {
+        layout.accepting[s] = nfa.states[s].accept ? 1 : 0;
+    }
+
+    // per target, the sources that reach it by one consuming edge plus epsilon moves, with a mismatch per class;
+    // several edges between the same pair keep the cheaper cost for every class
+    std::vector<std::map<int, std::vector<std::uint8_t>>> incoming(stateCount);
+    for (std::size_t s = 0; s < stateCount; ++s) {
+        for (const auto& edge : nfa.states[s].edges) {
+            if (!consumesSymbol(edge.type)) {
+                continue;
+            }
+            std::vector<std::uint8_t> costs(classCount);
+            for (std::size_t k = 0; k < classCount; ++k) {
+                costs[k] = edgeAccepts(edge, static_cast<char>(layout.classes.representatives[k])) ? 0 : 1;
+            }
+            epsilonClosure(nfa, {edge.to}, closure);
+            for (int t : closure.values()) {
+                auto [it, inserted] = incoming[t].try_emplace(static_cast<int>(s), costs);
+                if (!inserted) {
+                    for (std::size_t k = 0; k < classCount; ++k) {
+                        it->second[k] = std::min(it->second[k], costs[k]);
+                    }
+                }
+            }
+        }
+    }
+    layout.targetOffsets.assign(1, 0);
+    std::vector<const std::vector<std::uint8_t>*> entryCosts;
+    for (const auto& sources : incoming) {
+        for (const auto& [source, costs] : sources) {
+            layout.sources.push_back(source);
+            entryCosts.push_back(&costs);
+        }
+        layout.targetOffsets.push_back(layout.sources.size());
+    }
+    const auto entries = layout.sources.size();
+    layout.mismatches.resize(classCount * entries);
+    for (std::size_t k = 0; k < classCount; ++k) {
+        for (std::size_t i = 0; i < entries; ++i) {
+            layout.mismatches[k * entries + i] = (*entryCosts[i])[k];
+        }
+    }
+    return layout;
+}
+
+Dfa EfaBuilder::determinize(const Efa& efa, std::size_t maxStates) const {
+    const auto& nfa = efa.automaton;
+    const auto budget = efa.mismatchBudget;
+    const auto levels = budget + 1;
+    constexpr auto unreachable = std::numeric_limits<std::size_t>::max();
+
+    Dfa dfa;
+    // every byte a class groups together matches or mismatches each edge alike, so the classes still apply;
+    // the literal prefilter is only sound when no substitution is allowed
+    dfa.classes = computeByteClasses(nfa);
+    dfa.reportsMismatches = true;
+    if (budget == 0) {
+        dfa.required = nfa.required;
+    }
+    const auto classCount = dfa.classes.count;
+
+    // epsilon closure of each single state, taken once; epsilon edges cost nothing
+    std::vector<std::vector<int>> closures(nfa.states.size());
+    StateSet closure(nfa.states.size());
+    for (std::size_t s = 0; s < nfa.states.size(); ++s) {
+        epsilonClosure(nfa, {static_cast<int>(s)}, closure);
+        closures[s] = closure.values();
+    }
+
+    // a subset is a sorted list of state * levels + cost, keeping only the cheapest cost per NFA state
+    std::unordered_map<std::vector<int>, int, SubsetHash> subsetToId;
+    std::vector<std::vector<int>> subsets;
+    std::queue<int> pending;
+    auto intern = [&](std::vector<int> subset) {
+        auto it = subsetToId.find(subset);
+        if (it != subsetToId.end()) {
+            return it->second;
+        }
+        if (dfa.states.size() >= maxStates) {
+            throw DfaStateLimitExceeded("DFA construction exceeded the limit of " + std::to_string(maxStates) +
+                                        " states");
+        }
+        const int id = static_cast<int>(dfa.states.size());
+        DfaState state{};
+        state.mismatches = unreachable;
+        for (int entry : subset) {
+            const auto s = static_cast<std::size_t>(entry) / levels;
+            if (nfa.states[s].accept) {
+                state.accept = true;
+                state.mismatches = std::min(state.mismatches, static_cast<std::size_t>(entry) % levels);
+            }
+        }
+        if (!state.accept) {
+            state.mismatches = 0;
+        }
+        dfa.states.push_back(state);
+        dfa.transitions.resize(dfa.transitions.size() + classCount, -1);
+        subsetToId.emplace(subset, id);
+        subsets.push_back(std::move(subset));
+        pending.push(id);
+        return id;
+    };
+
+    // cheapest cost per NFA state for the subset being assembled; `reached` lists the states set so far
+    std::vector<std::size_t> costs(nfa.states.size(), unreachable);
+    std::vector<int> reached;
+    auto relax = [&](int state, std::size_t cost) {
+        for (int t : closures[state]) {
+            if (cost < costs[t]) {
+                if (costs[t] == unreachable) {
+                    reached.push_back(t);
+                }
+                costs[t] = cost;
+            }
+        }
+    };
+    auto collect = [&]() {
+        std::vector<int> subset;
+        subset.reserve(reached.size());
+        for (int t : reached) {
+            subset.push_back(static_cast<int>(static_cast<std::size_t>(t) * levels + costs[t]));
+            costs[t] = unreachable;
+        }
+        reached.clear();
+        std::sort(subset.begin(), subset.end());
+        return subset;
+    };
+
+    relax(nfa.start, 0);
+    intern(collect());
+
+    while (!pending.empty()) {
+        const int currentId = pending.front();
+        pending.pop();
+        for (std::size_t k = 0; k < classCount; ++k) {
+            const auto symbol = static_cast<char>(dfa.classes.representatives[k]);
+            for (int entry : subsets[currentId]) {
+                const auto s = static_cast<std::size_t>(entry) / levels;
+                const auto cost = static_cast<std::size_t>(entry) % levels;
+                for (const auto& edge : nfa.states[s].edges) {
+                    if (!consumesSymbol(edge.type)) {
+                        continue;
+                    }
+                    // a substitution costs one mismatch; paths past the budget are dropped
+                    const auto newCost = cost + (edgeAccepts(edge, symbol) ? 0 : 1);
+                    if (newCost <= budget) {
+                        relax(edge.to, newCost);
+                    }
+                }
+            }
+            if (reached.empty()) {
+                continue;
+            }
+            const int targetId = intern(collect());
+            dfa.transitions[static_cast<std::size_t>(currentId) * classCount + k] = targetId;
+        }
+    }
+
+    dfa.start = 0;
+    return dfa;
+}
+
+EditPattern EfaBuilder::buildEditPattern(const std::string& pattern) const {
+    const auto postfix = parser_.parseToPostfix(pattern);
+    std::vector<const RegexToken*> symbols;
+    for (const auto& token : postfix) {
+        if (token.type == RegexTokenType::Literal || token.type == RegexTokenType::CharClass ||
+            token.type == RegexTokenType::Any) {
+            symbols.push_back(&token);
+        } else if (token.type != RegexTokenType::Concat) {
+            throw std::runtime_error("Edit distance needs a pattern without alternation or repetition.");
+        }
+    }
+    if (symbols.empty()) {
+        throw std::runtime_error("Approximate matching requires a non-empty pattern.");
+    }
+    EditPattern edit;
+    edit.length = symbols.size();
+    edit.words = (edit.length + 63) / 64;
+    edit.masks.assign(256 * edit.words, 0);
+    for (std::size_t position = 0; position < edit.length; ++position) {
+        const auto& token = *symbols[position];
+        const auto bit = std::uint64_t{1} << (position % 64);
+        // the edge NfaBuilder would make for this token, so positions accept exactly what the NFA does
+        Edge edge{0, EdgeType::Any, '\0', {}};
+        if (token.type == RegexTokenType::Literal) {
+            edge.type = EdgeType::Literal;
+            edge.literal = token.text.empty() ? '\0' : token.text.front();
+        } else if (token.type == RegexTokenType::CharClass) {
+            edge.type = EdgeType::CharClass;
+            edge.charClass = token.text;
+        }
+        for (unsigned symbol = 0; symbol < 256; ++symbol) {
+            if (edgeAccepts(edge, static_cast<char>(symbol))) {
+                edit.masks[symbol * edit.words + position / 64] |= bit;
+            }
+        }
+    }
+    return edit;
 }
 
 }  // namespace automata
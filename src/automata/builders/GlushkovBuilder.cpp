@@ -0,0 +1,126 @@
+#include "automata/builders/Builders.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include "automata/utils/RequiredFactor.hpp"
+
+namespace automata {
+namespace {
+
+// first/last position sets of one sub-expression and whether it matches the empty string
+struct Fragment {
+    std::uint64_t first;
+    std::uint64_t last;
+    bool nullable;
+};
+
+// every position in `from` may be followed by every position in `to`
+void link(Glushkov& automaton, std::uint64_t from, std::uint64_t to) {
+    for (std::size_t p = 0; p < automaton.positions; ++p) {
+        if ((from >> p) & 1u) {
+            automaton.follow[p] |= to;
+        }
+    }
+}
+
+}  // namespace
+
+GlushkovBuilder::GlushkovBuilder(const RegexParser& parser) : parser_(parser) {}
+
+bool GlushkovBuilder::fits(const std::string& pattern) const {
+    std::vector<RegexToken> postfix;
+    try {
+        postfix = parser_.parseToPostfix(pattern);
+    } catch (const std::exception&) {
+        // leave invalid patterns to the engine that reports the error
+        return false;
+    }
+    const auto positions = std::count_if(postfix.begin(), postfix.end(), [](const RegexToken& token) {
+        return token.type == RegexTokenType::Literal || token.type == RegexTokenType::CharClass ||
+               token.type == RegexTokenType::Any;
+    });
+    return positions > 0 && static_cast<std::size_t>(positions) <= kMaxPositions;
+}
+
+Glushkov GlushkovBuilder::build(const std::string& pattern) const {
+    const auto postfix = parser_.parseToPostfix(pattern);
+    Glushkov automaton;
+    std::vector<Fragment> stack;
+    for (const auto& token : postfix) {
+        switch (token.type) {
+            case RegexTokenType::Literal:
+            case RegexTokenType::CharClass:
+            case RegexTokenType::Any: {
+                if (automaton.positions == kMaxPositions) {
+                    throw std::runtime_error("Pattern has more than 64 symbol positions.");
+                }
+                const auto bit = std::uint64_t{1} << automaton.positions;
+                // same acceptance rules as the NFA's literal, class and wildcard edges
+                for (unsigned symbol = 0; symbol < 256; ++symbol) {
+                    const char c = static_cast<char>(symbol);
+                    bool accepts = true;
+                    if (token.type == RegexTokenType::Literal) {
+                        accepts = c == (token.text.empty() ? '\0' : token.text.front());
+                    } else if (token.type == RegexTokenType::CharClass) {
+                        accepts = token.text.find(c) != std::string::npos;
+                    }
+                    if (accepts) {
+                        automaton.symbols[symbol] |= bit;
+                    }
+                }
+                automaton.follow.push_back(0);
+                ++automaton.positions;
+                stack.push_back({bit, bit, false});
+                break;
+            }
+            case RegexTokenType::Concat:
+            case RegexTokenType::Union: {
+                if (stack.size() < 2) {
+                    throw std::runtime_error("Invalid regex: operator missing operand.");
+                }
+                const auto right = stack.back();
+                stack.pop_back();
+                const auto left = stack.back();
+                stack.pop_back();
+                if (token.type == RegexTokenType::Union) {
+                    stack.push_back({left.first | right.first, left.last | right.last, left.nullable || right.nullable});
+                    break;
+                }
+                link(automaton, left.last, right.first);
+                stack.push_back({left.first | (left.nullable ? right.first : 0),
+                                 right.last | (right.nullable ? left.last : 0), left.nullable && right.nullable});
+                break;
+            }
+            case RegexTokenType::Star:
+            case RegexTokenType::Plus:
+            case RegexTokenType::Question: {
+                if (stack.empty()) {
+                    throw std::runtime_error("Invalid regex: repetition missing operand.");
+                }
+                auto& fragment = stack.back();
+                // repetitions loop from the last positions back to the first ones
+                if (token.type != RegexTokenType::Question) {
+                    link(automaton, fragment.last, fragment.first);
+                }
+                if (token.type != RegexTokenType::Plus) {
+                    fragment.nullable = true;
+                }
+                break;
+            }
+        }
+    }
+    if (stack.size() > 1) {
+        throw std::runtime_error("Invalid regex pattern produced multiple fragments.");
+    }
+    // an empty pattern only matches the empty string
+    const Fragment whole = stack.empty() ? Fragment{0, 0, true} : stack.back();
+    automaton.first = whole.first;
+    automaton.last = whole.last;
+    automaton.nullable = whole.nullable;
+    automaton.required = extractRequiredFactor(postfix);
+    return automaton;
+}
+
+}  // namespace automata
@@ -3,6 +3,9 @@
 #include <stack>
 #include <stdexcept>
 
+#include "automata/utils/RequiredFactor.hpp"
+#include "automata/utils/StateSet.hpp"
+
 namespace automata {
 namespace {
 
@@ -21,6 +24,45 @@ Edge makeEdge(int to, EdgeType type, char literal, const std::string& cls = {})
 
 NfaBuilder::NfaBuilder(const RegexParser& parser) : parser_(parser) {}
 
+Nfa reverseNfa(const Nfa& nfa) {
+    Nfa reversed;
+    reversed.states.resize(nfa.states.size());
+    for (std::size_t from = 0; from < nfa.states.size(); ++from) {
+        for (const auto& edge : nfa.states[from].edges) {
+            reversed.states[edge.to].edges.push_back(
+                makeEdge(static_cast<int>(from), edge.type, edge.literal, edge.charClass));
+        }
+    }
+    // a fresh start state fans out to every former accept state
+    const int start = static_cast<int>(reversed.states.size());
+    reversed.states.push_back(NfaState{});
+    for (std::size_t state = 0; state < nfa.states.size(); ++state) {
+        if (nfa.states[state].accept) {
+            reversed.states[start].edges.push_back(makeEdge(static_cast<int>(state), EdgeType::Epsilon, '\0'));
+        }
+    }
+    // the required factor's offsets are relative to the forward start, so the reversed NFA carries none
+    reversed.start = start;
+    reversed.accept = nfa.start;
+    reversed.states[nfa.start].accept = true;
+    computeEpsilonClosures(reversed);
+    return reversed;
+}
+
+Nfa unanchoredNfa(const Nfa& nfa) {
+    Nfa unanchored = nfa;
+    // the new start loops on any byte and can enter the pattern at every position
+    const int start = static_cast<int>(unanchored.states.size());
+    unanchored.states.push_back(NfaState{});
+    unanchored.states[start].edges.push_back(makeEdge(start, EdgeType::Any, '\0'));
+    unanchored.states[start].edges.push_back(makeEdge(nfa.start, EdgeType::Epsilon, '\0'));
+    unanchored.start = start;
+    // every offset can now start a match, so there is nothing left to skip
+    unanchored.required = RequiredFactor{};
+    computeEpsilonClosures(unanchored);
+    return unanchored;
+}
+
 Nfa NfaBuilder::build(const std::string& pattern) const {
     std::vector<NfaState> states;
 
@@ -47,7 +89,12 @@ Nfa NfaBuilder::build(const std::string& pattern) const {
         int accept = newState();
         addEdge(start, accept, EdgeType::Epsilon);
         states[accept].accept = true;
-        return Nfa{start, accept, states};
+        Nfa nfa;
+        nfa.start = start;
+        nfa.accept = accept;
+        nfa.states = std::move(states);
+        computeEpsilonClosures(nfa);
+        return nfa;
     }
 
     for (const auto& token : postfix) {
@@ -212,7 +259,14 @@ Nfa NfaBuilder::build(const std::string& pattern) const {
     // mark the accepting fragment state on the nfa states as true
     auto fragment = stack.back();
     states[fragment.accept].accept = true;
-    return Nfa{fragment.start, fragment.accept, states};
+    Nfa nfa;
+    nfa.start = fragment.start;
+    nfa.accept = fragment.accept;
+    nfa.states = std::move(states);
+    nfa.required = extractRequiredFactor(postfix);
+    // closures never change after construction, so compute them once for every runner and the subset construction
+    computeEpsilonClosures(nfa);
+    return nfa;
 }
 
 }  // namespace automata
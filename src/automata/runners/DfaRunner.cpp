@@ -1,27 +1,64 @@
 #include "automata/runners/Runners.hpp"
 
+#include <bit>
+#include <optional>
 #include <sstream>
+#include <vector>
+
+#include "automata/utils/RequiredFactor.hpp"
 
 namespace automata {
 
 DfaRunner::DfaRunner(Dfa dfa, bool trace) : dfa_(std::move(dfa)), trace_(trace) {}
 
 RunResult DfaRunner::run(const std::string& input) {
+    if (leftmostLongest_) {
+        return runLeftmostLongest(input);
+    }
     RunResult result;
     // shortcut: empty input matches when the start state itself is accepting
     if (input.empty() && dfa_.states[dfa_.start].accept) {
         result.accepted = true;
         result.matches.emplace_back(0, 0);
+        if (dfa_.reportsMismatches) {
+            result.distances.push_back(dfa_.states[dfa_.start].mismatches);
+        }
         return result;
     }
-    // try running the DFA from each possible start index
-    for (std::size_t start = 0; start < input.size(); ++start) {
+    // try running the DFA from each start index that the required literal leaves possible
+    CandidateScanner candidates(dfa_.required, input);
+    for (auto start = candidates.next(0); start != CandidateScanner::npos; start = candidates.next(start + 1)) {
         int state = dfa_.start;
+        std::size_t pos = start;
+        // strided fast path: one dependent table lookup per `stride` symbols; the accept mask still yields
+        // every exact end position. Traces want per-symbol detail and distances want each accepting state, so
+        // both always take the single-step loop.
+        if (dfa_.stride > 1 && !trace_ && !dfa_.reportsMismatches) {
+            while (pos + dfa_.stride <= input.size()) {
+                const auto& step = dfa_.strideStep(state, input.data() + pos);
+                result.statesVisited += step.consumed + (step.to < 0 ? 1 : 0);
+                for (unsigned mask = step.acceptMask; mask != 0; mask &= mask - 1) {
+                    const auto end = pos + static_cast<std::size_t>(std::countr_zero(mask)) + 1;
+                    result.matches.push_back({start, end});
+                    if (start == 0 && end == input.size()) {
+                        result.accepted = true;
+                    }
+                }
+                state = step.to;
+                if (state < 0) {
+                    break;
+                }
+                pos += dfa_.stride;
+            }
+            if (state < 0) {
+                continue;
+            }
+        }
         // advance through the input until the automaton can no longer transition
-        for (std::size_t pos = start; pos < input.size(); ++pos) {
+        for (; pos < input.size(); ++pos) {
             ++result.statesVisited;
             unsigned char c = static_cast<unsigned char>(input[pos]);
-            int next = dfa_.states[state].next[c];
+            int next = dfa_.next(state, c);
             if (trace_) {
                 std::ostringstream oss;
                 oss << "start=" << start << " pos=" << pos << " state=" << state << " next=" << next;
@@ -34,6 +71,9 @@ RunResult DfaRunner::run(const std::string& input) {
             // add any accepting matches reached after following the transition
             if (dfa_.states[state].accept) {
                 result.matches.push_back({start, pos + 1});
+                if (dfa_.reportsMismatches) {
+                    result.distances.push_back(dfa_.states[state].mismatches);
+                }
                 if (start == 0 && pos + 1 == input.size()) {
                     result.accepted = true;
                 }
@@ -43,4 +83,183 @@ RunResult DfaRunner::run(const std::string& input) {
     return result;
 }
 
+std::vector<RunResult> DfaRunner::runBatch(const std::vector<std::string>& inputs) {
+    // traces, strided tables and leftmost-longest search keep their sequential loops
+    if (trace_ || leftmostLongest_ || dfa_.stride > 1) {
+        return IRunner::runBatch(inputs);
+    }
+    std::vector<RunResult> results(inputs.size());
+    // one in-flight match attempt; a lane works through every candidate start of its input before taking the
+    // next input, so each result receives its matches in the same order as run() produces them
+    struct Lane {
+        std::size_t input;
+        std::size_t start;
+        std::size_t pos;
+        int state;
+        CandidateScanner candidates;
+    };
+    auto seek = [&](Lane& lane, std::size_t from) {
+        lane.start = lane.candidates.next(from);
+        lane.pos = lane.start;
+        lane.state = dfa_.start;
+        return lane.start != CandidateScanner::npos;
+    };
+    std::size_t nextInput = 0;
+    auto take = [&]() -> std::optional<Lane> {
+        while (nextInput < inputs.size()) {
+            const auto index = nextInput++;
+            if (inputs[index].empty()) {
+                if (dfa_.states[dfa_.start].accept) {
+                    results[index].accepted = true;
+                    results[index].matches.emplace_back(0, 0);
+                    if (dfa_.reportsMismatches) {
+                        results[index].distances.push_back(dfa_.states[dfa_.start].mismatches);
+                    }
+                }
+                continue;
+            }
+            Lane lane{index, 0, 0, dfa_.start, CandidateScanner(dfa_.required, inputs[index])};
+            if (seek(lane, 0)) {
+                return lane;
+            }
+        }
+        return std::nullopt;
+    };
+    std::vector<Lane> lanes;
+    lanes.reserve(kBatchLanes);
+    while (lanes.size() < kBatchLanes) {
+        auto lane = take();
+        if (!lane) {
+            break;
+        }
+        lanes.push_back(std::move(*lane));
+    }
+    while (!lanes.empty()) {
+        for (std::size_t i = 0; i < lanes.size();) {
+            auto& lane = lanes[i];
+            const auto& input = inputs[lane.input];
+            auto& result = results[lane.input];
+            ++result.statesVisited;
+            const int next = dfa_.next(lane.state, static_cast<unsigned char>(input[lane.pos]));
+            bool finished = next == -1;
+            if (!finished) {
+                lane.state = next;
+                ++lane.pos;
+                if (dfa_.states[next].accept) {
+                    result.matches.push_back({lane.start, lane.pos});
+                    if (dfa_.reportsMismatches) {
+                        result.distances.push_back(dfa_.states[next].mismatches);
+                    }
+                    if (lane.start == 0 && lane.pos == input.size()) {
+                        result.accepted = true;
+                    }
+                }
+                finished = lane.pos == input.size();
+            }
+            if (finished && !seek(lane, lane.start + 1)) {
+                if (auto fresh = take()) {
+                    lane = std::move(*fresh);
+                } else {
+                    // retire the lane by moving the last one into its slot, then step that one
+                    lane = lanes.back();
+                    lanes.pop_back();
+                    continue;
+                }
+            }
+            ++i;
+        }
+    }
+    return results;
+}
+
+RunResult DfaRunner::runLeftmostLongest(const std::string& input) {
+    RunResult result;
+    if (input.empty()) {
+        if (dfa_.states[dfa_.start].accept) {
+            result.accepted = true;
+            result.matches.emplace_back(0, 0);
+        }
+        return result;
+    }
+    // forward pass over ".*pattern": one transition per byte, and the last accepting position bounds every
+    // match end. Without any accepting position the input has no match and we are done.
+    std::size_t lastEnd = 0;
+    int state = forward_.start;
+    std::size_t scanned = 0;
+    if (forward_.stride > 1) {
+        for (; scanned + forward_.stride <= input.size(); scanned += forward_.stride) {
+            const auto& step = forward_.strideStep(state, input.data() + scanned);
+            result.statesVisited += forward_.stride;
+            if (step.acceptMask != 0) {
+                lastEnd = scanned + static_cast<std::size_t>(std::bit_width(static_cast<unsigned>(step.acceptMask)));
+            }
+            state = step.to;
+        }
+    }
+    for (std::size_t pos = scanned; pos < input.size(); ++pos) {
+        state = forward_.next(state, static_cast<unsigned char>(input[pos]));
+        ++result.statesVisited;
+        if (state < 0) {
+            break;
+        }
+        if (forward_.states[state].accept) {
+            lastEnd = pos + 1;
+        }
+    }
+    if (trace_) {
+        result.trace.push_back({0, "forward pass: last match end=" + std::to_string(lastEnd)});
+    }
+    if (lastEnd == 0) {
+        return result;
+    }
+    // reverse pass over ".*reversed pattern" from the last end: accepting after reading input[pos]
+    // means some match starts at pos
+    std::vector<bool> startsHere(lastEnd, false);
+    state = reverse_.start;
+    for (std::size_t pos = lastEnd; pos-- > 0;) {
+        state = reverse_.next(state, static_cast<unsigned char>(input[pos]));
+        ++result.statesVisited;
+        if (state < 0) {
+            break;
+        }
+        startsHere[pos] = reverse_.states[state].accept;
+    }
+    // take the leftmost uncovered start and extend it as far as the anchored DFA accepts
+    std::size_t cursor = 0;
+    while (cursor < lastEnd) {
+        if (!startsHere[cursor]) {
+            ++cursor;
+            continue;
+        }
+        std::size_t end = cursor;
+        state = dfa_.start;
+        for (std::size_t pos = cursor; pos < lastEnd; ++pos) {
+            state = dfa_.next(state, static_cast<unsigned char>(input[pos]));
+            ++result.statesVisited;
+            if (state < 0) {
+                break;
+            }
+            if (dfa_.states[state].accept) {
+                end = pos + 1;
+            }
+        }
+        // start hints from a nullable pattern may only admit the empty match, which is not reported
+        if (end == cursor) {
+            ++cursor;
+            continue;
+        }
+        if (trace_) {
+            std::ostringstream oss;
+            oss << "match start=" << cursor << " end=" << end;
+            result.trace.push_back({cursor, oss.str()});
+        }
+        result.matches.emplace_back(cursor, end);
+        if (cursor == 0 && end == input.size()) {
+            result.accepted = true;
+        }
+        cursor = end;
+    }
+    return result;
+}
+
 }  // namespace automata
@@ -1,108 +1,58 @@
 #include "automata/runners/Runners.hpp"
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <sstream>
 #include <vector>
 
+#include "automata/utils/RequiredFactor.hpp"
+#include "automata/utils/TopHits.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUTOMATA_HAVE_AVX2_KERNEL 1
+#endif
+
 namespace automata {
-namespace {
 
-// helper returns a mismatch cost greater than the allowed budget to mark unreachable states
-std::size_t unreachableCost(std::size_t budget) {
-    return budget + 1;
+EfaRunner::EfaRunner(Efa efa, bool trace)
+    : efa_(std::move(efa)), trace_(trace), kernel_(&EfaRunner::scanLanesScalar) {
+#ifdef AUTOMATA_HAVE_AVX2_KERNEL
+    if (__builtin_cpu_supports("avx2")) {
+        kernel_ = &EfaRunner::scanLanesAvx2;
+        vectorized_ = true;
+    }
+#endif
 }
 
-// alias for the vector that tracks mismatch cost per state
-using CostVector = std::vector<std::size_t>;
-
-// compute epsilon closure using the current mismatch costs and budget; needed because epsilon transitions
-// do not consume symbols but still affect the set of reachable states and their mismatch costs.
-CostVector epsilonClosureWithCosts(const Nfa& nfa, CostVector costs, std::size_t budget) {
-    std::queue<int> q;
-    std::vector<bool> inQueue(nfa.states.size(), false);
-    for (std::size_t i = 0; i < costs.size(); ++i) {
-        if (costs[i] <= budget) {
-            q.push(static_cast<int>(i));
-            inQueue[i] = true;
-        }
+void EfaRunner::closeWithCosts(const Nfa& nfa) {
+    // epsilon edges cost nothing, so a state's cost can only drop to that of a predecessor; revisit a state
+    // whenever its cost improves until nothing changes
+    queue_.assign(touched_.begin(), touched_.end());
+    for (int state : queue_) {
+        inQueue_[state] = true;
     }
-    while (!q.empty()) {
-        const int state = q.front();
-        q.pop();
-        inQueue[state] = false;
-        const auto cost = costs[state];
+    for (std::size_t head = 0; head < queue_.size(); ++head) {
+        const int state = queue_[head];
+        inQueue_[state] = false;
+        const auto cost = costs_[state];
         for (const auto& edge : nfa.states[state].edges) {
-            if (edge.type != EdgeType::Epsilon) {
+            if (edge.type != EdgeType::Epsilon || cost >= costs_[edge.to]) {
                 continue;
             }
-            if (cost < costs[edge.to]) {
-                costs[edge.to] = cost;
-                if (!inQueue[edge.to]) {
-                    q.push(edge.to);
-                    inQueue[edge.to] = true;
-                }
+            if (costs_[edge.to] == kUnreachable) {
+                touched_.push_back(edge.to);
+            }
+            costs_[edge.to] = cost;
+            if (!inQueue_[edge.to]) {
+                queue_.push_back(edge.to);
+                inQueue_[edge.to] = true;
             }
         }
     }
-    return costs;
-}
-
-// helpers that describe how edge types consume input symbols (used in mismatch accounting)
-bool consumesSymbol(EdgeType type) {
-    return type == EdgeType::Literal || type == EdgeType::Any || type == EdgeType::CharClass;
-}
-
-// determine if the current edge accepts the symbol (Literal/Any/CharClass are relevant)
-bool matchesEdge(const Edge& edge, char symbol) {
-    switch (edge.type) {
-        case EdgeType::Literal:
-            return edge.literal == symbol;
-        case EdgeType::Any:
-            return true;
-        case EdgeType::CharClass:
-            return edge.charClass.find(symbol) != std::string::npos;
-        default:
-            break;
-    }
-    return false;
-}
-
-// count how many states are still under the mismatch budget so we can stop early if none remain
-std::size_t activeCount(const CostVector& costs, std::size_t budget) {
-    std::size_t count = 0;
-    for (auto cost : costs) {
-        if (cost <= budget) {
-            ++count;
-        }
-    }
-    return count;
-}
-
-// check whether any active state is accepting, used for match detection
-bool hasAccepting(const Nfa& nfa, const CostVector& costs, std::size_t budget) {
-    for (std::size_t i = 0; i < costs.size(); ++i) {
-        if (costs[i] <= budget && nfa.states[i].accept) {
-            return true;
-        }
-    }
-    return false;
-}
-
-// find the best (lowest) mismatch cost among active states, primarily for trace output detail
-std::size_t minMismatch(const CostVector& costs, std::size_t budget) {
-    std::size_t best = budget + 1;
-    for (auto cost : costs) {
-        if (cost <= budget && cost < best) {
-            best = cost;
-        }
-    }
-    return best;
 }
 
-}  // namespace
-
-EfaRunner::EfaRunner(Efa efa, bool trace) : efa_(std::move(efa)), trace_(trace) {}
-
 RunResult EfaRunner::run(const std::string& input) {
     RunResult result;
     // simulate against the stored NFA underlying the EFA
@@ -110,87 +60,298 @@ RunResult EfaRunner::run(const std::string& input) {
     if (nfa.states.empty()) {
         return result;
     }
-    const auto budget = efa_.mismatchBudget;
-    const auto unreachable = unreachableCost(budget);
+    auto budget = efa_.mismatchBudget;
+    TopHits hits(reportLimit_, budget);
+    costs_.assign(nfa.states.size(), kUnreachable);
+    inQueue_.assign(nfa.states.size(), false);
 
-    // initialize every state to unreachable, except the start state
-    CostVector startCosts(nfa.states.size(), unreachable);
-    startCosts[nfa.start] = 0;
-    startCosts = epsilonClosureWithCosts(nfa, std::move(startCosts), budget);
+    // the start closure as (state, cost) threads, injected as a fresh attempt at every candidate offset
+    touched_.assign(1, nfa.start);
+    costs_[nfa.start] = 0;
+    closeWithCosts(nfa);
+    startThreads_.clear();
+    bool startAccepts = false;
+    for (int state : touched_) {
+        startThreads_.push_back({state, costs_[state], 0});
+        startAccepts = startAccepts || nfa.states[state].accept;
+        costs_[state] = kUnreachable;
+    }
 
     // handle the empty input case using only the epsilon closure of the start
     // (e.g., a pattern like "(|a)" can accept immediately without consuming characters)
     if (input.empty()) {
-        if (hasAccepting(nfa, startCosts, budget)) {
+        if (startAccepts) {
             result.accepted = true;
             result.matches.emplace_back(0, 0);
+            if (reportLimit_ > 0) {
+                result.distances.push_back(0);
+            }
         }
         return result;
     }
 
-    bool entireMatch = false;
-    const auto baseActive = activeCount(startCosts, budget);
-    if (baseActive == 0) {
-        return result;
+    // dense searches step 32 start offsets at once; seeded ones start too rarely to fill the lanes, and an Efa
+    // assembled without EfaBuilder has no edge layout, so both keep the thread simulation
+    const bool laidOut = efa_.layout.accepting.size() == nfa.states.size();
+    if (!trace_ && reportLimit_ == 0 && efa_.seeds.empty() && laidOut) {
+        return runLanes(input);
     }
-    // try each possible start position and track mismatch-aware costs; budget replays per start
-    // mismatches are limited by the budget, so characters that push costs beyond it are skipped
-    for (std::size_t start = 0; start < input.size(); ++start) {
-        auto current = startCosts;
-        for (std::size_t pos = start; pos < input.size(); ++pos) {
-            CostVector next(nfa.states.size(), unreachable);
-            const char symbol = input[pos];
-            // consider every active state for the current character, building the next cost vector
-            for (std::size_t state = 0; state < current.size(); ++state) {
-                const auto cost = current[state];
-                if (cost > budget) {
-                    continue;
-                }
-                for (const auto& edge : nfa.states[state].edges) {
+
+    bool entireMatch = false;
+    current_.clear();
+    // single left-to-right pass: every attempt is a group of (state, cost) threads tagged with its start offset.
+    // Groups stay ordered by start and are stepped independently, so each reports exactly the intervals a
+    // rescan from its start would. An exact search (budget 0) only starts attempts where its required literal
+    // leaves a match possible; an approximate one with seeds only where one of them lines up.
+    const RequiredFactor noFactor;
+    CandidateScanner candidates(budget == 0 ? nfa.required : noFactor, input);
+    SeedScanner seeds(efa_.seeds, input);
+    auto candidate = [&](std::size_t from) { return efa_.seeds.empty() ? candidates.next(from) : seeds.next(from); };
+    auto nextStart = candidate(0);
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        // with no attempt alive, jump straight to the next start offset
+        if (current_.empty()) {
+            if (nextStart == CandidateScanner::npos) {
+                break;
+            }
+            pos = nextStart;
+        }
+        if (pos == nextStart) {
+            for (const auto& thread : startThreads_) {
+                current_.push_back({thread.state, thread.cost, pos});
+            }
+            nextStart = candidate(pos + 1);
+        }
+        next_.clear();
+        const char symbol = input[pos];
+        std::size_t index = 0;
+        while (index < current_.size()) {
+            const auto start = current_[index].start;
+            touched_.clear();
+            // consider every live state of this attempt for the current character, keeping the cheapest cost
+            for (; index < current_.size() && current_[index].start == start; ++index) {
+                const auto& thread = current_[index];
+                for (const auto& edge : nfa.states[thread.state].edges) {
                     if (!consumesSymbol(edge.type)) {
                         continue;
                     }
-                    const bool matches = matchesEdge(edge, symbol);
-                    const auto newCost = cost + (matches ? 0 : 1);
-                    if (newCost > budget) {
+                    const auto newCost = static_cast<std::size_t>(thread.cost) + (edgeAccepts(edge, symbol) ? 0 : 1);
+                    // mismatches are limited by the budget, so paths that exceed it are dropped
+                    if (newCost > budget || newCost >= costs_[edge.to]) {
                         continue;
                     }
-                    const auto to = static_cast<std::size_t>(edge.to);
-                    // only update if this path gives a lower mismatch count
-                    if (newCost >= next[to]) {
-                        continue;
+                    if (costs_[edge.to] == kUnreachable) {
+                        touched_.push_back(edge.to);
                     }
-                    next[to] = newCost;
+                    costs_[edge.to] = static_cast<Cost>(newCost);
                 }
             }
-            current = epsilonClosureWithCosts(nfa, std::move(next), budget);
-            const auto active = activeCount(current, budget);
-            // stop consuming when no states remain within the budget
-            if (active == 0) {
-                break;
+            closeWithCosts(nfa);
+            // an attempt with no state left within the budget is dropped here
+            if (touched_.empty()) {
+                continue;
+            }
+            // the reached states become the attempt's next threads; acceptance and the best cost are read off
+            // while costs_ is reset behind them
+            Cost acceptCost = kUnreachable;
+            Cost best = kUnreachable;
+            for (int state : touched_) {
+                const auto cost = costs_[state];
+                if (nfa.states[state].accept) {
+                    acceptCost = std::min(acceptCost, cost);
+                }
+                best = std::min(best, cost);
+                next_.push_back({state, cost, start});
+                costs_[state] = kUnreachable;
             }
             // record effort for diagnostics
-            result.statesVisited += active;
+            result.statesVisited += touched_.size();
             if (trace_) {
                 std::ostringstream oss;
-                const auto best = minMismatch(current, budget);
-                oss << "start=" << start << " pos=" << pos << " states=" << active;
-                if (best <= budget) {
-                    oss << " bestMismatch=" << best;
-                }
+                oss << "start=" << start << " pos=" << pos << " states=" << touched_.size()
+                    << " bestMismatch=" << static_cast<unsigned>(best);
                 result.trace.push_back({pos, oss.str()});
             }
             // if any active state is accepting, record the match interval
-            if (hasAccepting(nfa, current, budget)) {
+            if (acceptCost == kUnreachable) {
+                continue;
+            }
+            if (reportLimit_ > 0) {
+                hits.add(start, pos + 1, acceptCost);
+                budget = hits.budget();
+            } else {
                 result.matches.emplace_back(start, pos + 1);
                 if (start == 0 && pos + 1 == input.size()) {
                     entireMatch = true;
                 }
             }
         }
+        current_.swap(next_);
+        // full of exact hits: nothing later can be kept
+        if (hits.closed()) {
+            break;
+        }
+    }
+    if (reportLimit_ > 0) {
+        hits.finish(result);
+        const auto whole = std::make_pair(std::size_t{0}, input.size());
+        result.accepted = std::find(result.matches.begin(), result.matches.end(), whole) != result.matches.end();
+        return result;
     }
+    // matches are discovered by end position; report them ordered by start like a per-start scan would
+    std::sort(result.matches.begin(), result.matches.end());
     result.accepted = entireMatch;
     return result;
 }
 
+RunResult EfaRunner::runLanes(const std::string& input) {
+    RunResult result;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(input.data());
+    // same start filtering as the thread simulation; offsets inside a block it rules out stay idle
+    const RequiredFactor noFactor;
+    CandidateScanner candidates(efa_.mismatchBudget == 0 ? efa_.automaton.required : noFactor, input);
+    auto candidate = candidates.next(0);
+    while (candidate != CandidateScanner::npos) {
+        const auto base = candidate;
+        std::uint32_t lanes = 0;
+        while (candidate != CandidateScanner::npos && candidate < base + kLanes) {
+            lanes |= std::uint32_t{1} << (candidate - base);
+            candidate = candidates.next(candidate + 1);
+        }
+        acceptMasks_.clear();
+        const auto consumed = (this->*kernel_)(bytes + base, input.size() - base, lanes, acceptMasks_,
+                                               result.statesVisited);
+        for (std::size_t t = 0; t < consumed; ++t) {
+            for (auto mask = acceptMasks_[t]; mask != 0; mask &= mask - 1) {
+                const auto start = base + static_cast<std::size_t>(std::countr_zero(mask));
+                result.matches.emplace_back(start, base + t + 1);
+                if (start == 0 && base + t + 1 == input.size()) {
+                    result.accepted = true;
+                }
+            }
+        }
+    }
+    // blocks report end-major; list start-major like the thread simulation
+    std::sort(result.matches.begin(), result.matches.end());
+    return result;
+}
+
+std::size_t EfaRunner::scanLanesScalar(const unsigned char* input, std::size_t length, std::uint32_t candidates,
+                                       std::vector<std::uint32_t>& acceptMasks, std::size_t& visited) {
+    const auto& layout = efa_.layout;
+    const auto states = layout.accepting.size();
+    const auto entries = layout.sources.size();
+    const auto budget = static_cast<Cost>(efa_.mismatchBudget);
+    laneCosts_.assign(states * kLanes, kUnreachable);
+    nextLaneCosts_.assign(states * kLanes, kUnreachable);
+    std::size_t t = 0;
+    while (t < length) {
+        // lane t begins its attempt at this byte when its offset is a candidate start
+        if (t < kLanes && ((candidates >> t) & 1u) != 0) {
+            for (int state : layout.startStates) {
+                laneCosts_[static_cast<std::size_t>(state) * kLanes + t] = 0;
+            }
+        }
+        const auto* mismatch = &layout.mismatches[layout.classes.map[input[t]] * entries];
+        std::array<Cost, kLanes> live;
+        std::array<Cost, kLanes> accept;
+        live.fill(kUnreachable);
+        accept.fill(kUnreachable);
+        for (std::size_t state = 0; state < states; ++state) {
+            auto* out = &nextLaneCosts_[state * kLanes];
+            std::fill(out, out + kLanes, kUnreachable);
+            for (auto i = layout.targetOffsets[state]; i < layout.targetOffsets[state + 1]; ++i) {
+                const auto* in = &laneCosts_[static_cast<std::size_t>(layout.sources[i]) * kLanes];
+                const auto w = mismatch[i];
+                for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                    // saturating: unreachable stays unreachable
+                    const auto cost = static_cast<Cost>(std::min<unsigned>(in[lane] + w, kUnreachable));
+                    out[lane] = std::min(out[lane], cost);
+                }
+            }
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                // every (state, lane) cell within budget is a thread the simulation would step
+                visited += out[lane] <= budget ? 1 : 0;
+                live[lane] = std::min(live[lane], out[lane]);
+                if (layout.accepting[state] != 0) {
+                    accept[lane] = std::min(accept[lane], out[lane]);
+                }
+            }
+        }
+        laneCosts_.swap(nextLaneCosts_);
+        std::uint32_t alive = 0;
+        std::uint32_t accepted = 0;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            alive |= static_cast<std::uint32_t>(live[lane] <= budget) << lane;
+            accepted |= static_cast<std::uint32_t>(accept[lane] <= budget) << lane;
+        }
+        acceptMasks.push_back(accepted);
+        ++t;
+        // stop once every attempt has died and no lane is left to start
+        if (alive == 0 && (t >= kLanes || (candidates >> t) == 0)) {
+            break;
+        }
+    }
+    return t;
+}
+
+#ifdef AUTOMATA_HAVE_AVX2_KERNEL
+__attribute__((target("avx2"))) std::size_t EfaRunner::scanLanesAvx2(const unsigned char* input, std::size_t length,
+                                                                     std::uint32_t candidates,
+                                                                     std::vector<std::uint32_t>& acceptMasks,
+                                                                     std::size_t& visited) {
+    static_assert(kLanes == sizeof(__m256i), "one lane per byte of an AVX2 register");
+    const auto& layout = efa_.layout;
+    const auto states = layout.accepting.size();
+    const auto entries = layout.sources.size();
+    laneCosts_.assign(states * kLanes, kUnreachable);
+    nextLaneCosts_.assign(states * kLanes, kUnreachable);
+    const auto unreachable = _mm256_set1_epi8(static_cast<char>(kUnreachable));
+    const auto budget = _mm256_set1_epi8(static_cast<char>(efa_.mismatchBudget));
+    // indexed by an entry's mismatch cost for the current byte
+    const __m256i increments[2] = {_mm256_setzero_si256(), _mm256_set1_epi8(1)};
+    auto row = [](std::vector<Cost>& costs, std::size_t state) {
+        return reinterpret_cast<__m256i*>(costs.data() + state * kLanes);
+    };
+    std::size_t t = 0;
+    while (t < length) {
+        if (t < kLanes && ((candidates >> t) & 1u) != 0) {
+            for (int state : layout.startStates) {
+                laneCosts_[static_cast<std::size_t>(state) * kLanes + t] = 0;
+            }
+        }
+        const auto* mismatch = &layout.mismatches[layout.classes.map[input[t]] * entries];
+        auto live = unreachable;
+        auto accept = unreachable;
+        for (std::size_t state = 0; state < states; ++state) {
+            auto out = unreachable;
+            for (auto i = layout.targetOffsets[state]; i < layout.targetOffsets[state + 1]; ++i) {
+                const auto in = _mm256_loadu_si256(row(laneCosts_, static_cast<std::size_t>(layout.sources[i])));
+                out = _mm256_min_epu8(out, _mm256_adds_epu8(in, increments[mismatch[i]]));
+            }
+            _mm256_storeu_si256(row(nextLaneCosts_, state), out);
+            // a lane is within budget where min(cost, budget) == cost
+            const auto within = _mm256_cmpeq_epi8(_mm256_min_epu8(out, budget), out);
+            const auto withinMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(within));
+            visited += static_cast<std::size_t>(std::popcount(withinMask));
+            live = _mm256_min_epu8(live, out);
+            if (layout.accepting[state] != 0) {
+                accept = _mm256_min_epu8(accept, out);
+            }
+        }
+        laneCosts_.swap(nextLaneCosts_);
+        const auto alive = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(live, budget), live)));
+        const auto accepted = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(accept, budget), accept)));
+        acceptMasks.push_back(accepted);
+        ++t;
+        if (alive == 0 && (t >= kLanes || (candidates >> t) == 0)) {
+            break;
+        }
+    }
+    return t;
+}
+#endif
+
 }  // namespace automata
@@ -0,0 +1,177 @@
+#include "automata/runners/Runners.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include "automata/utils/ByteClasses.hpp"
+
+namespace automata {
+namespace {
+
+constexpr int kUnknown = -2;
+constexpr int kDead = -1;
+// flushing this many times during one run means the working set does not fit the budget
+constexpr std::size_t kMaxFlushesPerRun = 8;
+
+// approximate bytes one cached state costs: its subset (stored twice, in the state and as the map key),
+// its row of per-class transitions and the bookkeeping around both
+std::size_t stateCost(const std::vector<int>& subset, std::size_t classCount) {
+    return 2 * subset.size() * sizeof(int) + classCount * sizeof(int) + 64;
+}
+
+// keep, from every uncovered start, only its longest non-empty match (matches arrive sorted by start, then end)
+void keepLeftmostLongest(RunResult& result, std::size_t inputSize) {
+    std::vector<std::pair<std::size_t, std::size_t>> kept;
+    std::size_t cursor = 0;
+    std::size_t index = 0;
+    while (index < result.matches.size()) {
+        const auto start = result.matches[index].first;
+        std::size_t end = start;
+        for (; index < result.matches.size() && result.matches[index].first == start; ++index) {
+            end = std::max(end, result.matches[index].second);
+        }
+        if (start >= cursor && end > start) {
+            kept.emplace_back(start, end);
+            cursor = end;
+        }
+    }
+    result.accepted = !kept.empty() && kept.front().first == 0 && kept.front().second == inputSize;
+    result.matches = std::move(kept);
+}
+
+}  // namespace
+
+LazyDfaRunner::LazyDfaRunner(Nfa nfa, std::size_t cacheBudget, bool trace)
+    : nfa_(std::move(nfa)),
+      cacheBudget_(cacheBudget),
+      trace_(trace),
+      classes_(computeByteClasses(nfa_)),
+      moved_(nfa_.states.size()),
+      reached_(nfa_.states.size()) {
+    flush();
+    flushes_ = 0;
+}
+
+void LazyDfaRunner::flush() {
+    states_.clear();
+    transitions_.clear();
+    subsetToId_.clear();
+    cacheBytes_ = 0;
+    ++flushes_;
+    // the start state always lives at id 0 so runs can restart from it after a flush
+    epsilonClosure(nfa_, {nfa_.start}, reached_);
+    subset_ = reached_.values();
+    std::sort(subset_.begin(), subset_.end());
+    intern(subset_);
+}
+
+int LazyDfaRunner::intern(const std::vector<int>& subset) {
+    auto it = subsetToId_.find(subset);
+    if (it != subsetToId_.end()) {
+        return it->second;
+    }
+    const auto cost = stateCost(subset, classes_.count);
+    // keep at least the start state so a single oversized subset cannot flush forever
+    if (cacheBytes_ + cost > cacheBudget_ && states_.size() > 1) {
+        // copy first: subset may alias subset_, which flush() reuses for the start state
+        const auto pending = subset;
+        flush();
+        return intern(pending);
+    }
+    const int id = static_cast<int>(states_.size());
+    CachedState state;
+    state.subset = subset;
+    for (int s : subset) {
+        if (nfa_.states[s].accept) {
+            state.accept = true;
+            break;
+        }
+    }
+    states_.push_back(std::move(state));
+    transitions_.resize(states_.size() * classes_.count, kUnknown);
+    subsetToId_.emplace(subset, id);
+    cacheBytes_ += cost;
+    return id;
+}
+
+int LazyDfaRunner::step(int state, unsigned char symbol) {
+    const auto slot = static_cast<std::size_t>(state) * classes_.count + classes_.map[symbol];
+    if (transitions_[slot] != kUnknown) {
+        return transitions_[slot];
+    }
+    // determinize just this transition: move + closure from the cached subset
+    move(nfa_, states_[state].subset, static_cast<char>(symbol), moved_);
+    epsilonClosure(nfa_, moved_.values(), reached_);
+    if (reached_.empty()) {
+        transitions_[slot] = kDead;
+        return kDead;
+    }
+    subset_ = reached_.values();
+    std::sort(subset_.begin(), subset_.end());
+    const auto generation = flushes_;
+    const int target = intern(subset_);
+    // a flush while interning invalidated `state`, so the transition cannot be recorded
+    if (generation == flushes_) {
+        transitions_[slot] = target;
+    }
+    return target;
+}
+
+RunResult LazyDfaRunner::run(const std::string& input) {
+    auto result = scan(input);
+    if (leftmostLongest_ && !input.empty()) {
+        keepLeftmostLongest(result, input.size());
+    }
+    return result;
+}
+
+RunResult LazyDfaRunner::scan(const std::string& input) {
+    RunResult result;
+    // shortcut: empty input matches when the start state itself is accepting
+    if (input.empty()) {
+        if (states_[0].accept) {
+            result.accepted = true;
+            result.matches.emplace_back(0, 0);
+        }
+        return result;
+    }
+    const auto firstFlush = flushes_;
+    // same sliding restart as DfaRunner, but each transition is built the first time the input needs it
+    for (std::size_t start = 0; start < input.size(); ++start) {
+        int state = 0;
+        for (std::size_t pos = start; pos < input.size(); ++pos) {
+            ++result.statesVisited;
+            const int next = step(state, static_cast<unsigned char>(input[pos]));
+            if (trace_) {
+                std::ostringstream oss;
+                oss << "start=" << start << " pos=" << pos << " state=" << state << " next=" << next
+                    << " cached=" << states_.size();
+                result.trace.push_back({pos, oss.str()});
+            }
+            if (next == kDead) {
+                break;
+            }
+            state = next;
+            if (states_[state].accept) {
+                result.matches.push_back({start, pos + 1});
+                if (start == 0 && pos + 1 == input.size()) {
+                    result.accepted = true;
+                }
+            }
+        }
+        // the cache keeps thrashing: stop determinizing and simulate the NFA for this input instead
+        if (flushes_ - firstFlush > kMaxFlushesPerRun) {
+            NfaRunner fallback(nfa_, trace_);
+            auto simulated = fallback.run(input);
+            if (trace_) {
+                simulated.trace.insert(simulated.trace.begin(),
+                                       {0, "lazy DFA cache exceeded its budget; falling back to NFA simulation"});
+            }
+            return simulated;
+        }
+    }
+    return result;
+}
+
+}  // namespace automata
@@ -0,0 +1,204 @@
+#include "automata/runners/Runners.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "automata/utils/TopHits.hpp"
+
+namespace automata {
+namespace {
+
+constexpr std::size_t kWordBits = 64;
+
+// one column step of a 64-row block (Hyyrö's formulation): `hin` is the horizontal delta entering at the
+// block's top row, the return value the delta leaving its `high` row
+int advanceBlock(std::uint64_t& pv, std::uint64_t& mv, std::uint64_t eq, int hin, std::uint64_t high) {
+    const auto xv = eq | mv;
+    if (hin < 0) {
+        eq |= 1;
+    }
+    const auto xh = (((eq & pv) + pv) ^ pv) | eq;
+    auto ph = mv | ~(xh | pv);
+    auto mh = pv & xh;
+    const int hout = (ph & high) != 0 ? 1 : (mh & high) != 0 ? -1 : 0;
+    ph <<= 1;
+    mh <<= 1;
+    if (hin < 0) {
+        mh |= 1;
+    } else if (hin > 0) {
+        ph |= 1;
+    }
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+
+}  // namespace
+
+MyersRunner::MyersRunner(EditPattern pattern, std::size_t budget, bool trace)
+    : pattern_(std::move(pattern)), budget_(budget), trace_(trace) {
+    // with a budget of m or more the empty alignment matches everywhere
+    if (budget_ >= pattern_.length) {
+        throw std::runtime_error("Edit-distance budget must be smaller than the pattern length.");
+    }
+    const auto words = pattern_.words;
+    reversedMasks_.assign(pattern_.masks.size(), 0);
+    for (unsigned symbol = 0; symbol < 256; ++symbol) {
+        for (std::size_t position = 0; position < pattern_.length; ++position) {
+            if (pattern_.accepts(position, static_cast<unsigned char>(symbol))) {
+                const auto reversed = pattern_.length - 1 - position;
+                reversedMasks_[symbol * words + reversed / kWordBits] |= std::uint64_t{1} << (reversed % kWordBits);
+            }
+        }
+    }
+}
+
+std::size_t MyersRunner::recoverStart(const std::string& input, std::size_t end, std::size_t span,
+                                      std::size_t& whole) {
+    const auto words = pattern_.words;
+    const auto length = pattern_.length;
+    span = std::min(span, end);
+    // walking leftwards from `end` aligns the reversed pattern against the reversed text with both anchored at
+    // `end`, so the same column update applies with +1 entering the top row (D[0][l] = l); the bottom row's
+    // score after l steps is the distance of the whole pattern to input[end - l, end)
+    backPv_.assign(words, ~std::uint64_t{0});
+    backMv_.assign(words, 0);
+    auto score = length;
+    auto best = score;
+    auto start = end;
+    for (std::size_t l = 1; l <= span; ++l) {
+        const auto* eq = &reversedMasks_[static_cast<unsigned char>(input[end - l]) * words];
+        int carry = 1;
+        for (std::size_t block = 0; block < words; ++block) {
+            const auto rows = block + 1 < words ? kWordBits : length - kWordBits * block;
+            carry = advanceBlock(backPv_[block], backMv_[block], eq[block], carry, std::uint64_t{1} << (rows - 1));
+        }
+        score += carry;
+        // ties go to the longer span
+        if (score <= best) {
+            best = score;
+            start = end - l;
+        }
+    }
+    whole = span == end ? score : std::numeric_limits<std::size_t>::max();
+    return start;
+}
+
+RunResult MyersRunner::run(const std::string& input) {
+    RunResult result;
+    // ranked reports lower the budget as better hits come in, which also narrows the band of active blocks
+    auto budget = budget_;
+    TopHits hits(reportLimit_, budget);
+    const auto words = pattern_.words;
+    const auto length = pattern_.length;
+    auto rows = [&](std::size_t block) { return block + 1 < words ? kWordBits : length - kWordBits * block; };
+    auto high = [&](std::size_t block) { return std::uint64_t{1} << (rows(block) - 1); };
+    // `distance` is the best distance of an alignment ending after pos, or above the budget when the last block
+    // is inactive
+    auto record = [&](std::size_t pos, std::size_t blocks, std::size_t distance) {
+        if (trace_) {
+            std::ostringstream oss;
+            oss << "pos=" << pos << " blocks=" << blocks;
+            if (blocks == words) {
+                oss << " distance=" << distance;
+            }
+            result.trace.push_back({pos, oss.str()});
+        }
+        if (distance > budget) {
+            return;
+        }
+        // an alignment at distance d spans at most length + d symbols; at the last byte the window also covers
+        // the whole input whenever that could be within the budget
+        const auto atEnd = pos + 1 == input.size();
+        std::size_t whole = 0;
+        const auto start = recoverStart(input, pos + 1, length + (atEnd ? budget : distance), whole);
+        if (reportLimit_ > 0) {
+            hits.add(start, pos + 1, distance);
+            budget = hits.budget();
+            return;
+        }
+        result.matches.emplace_back(start, pos + 1);
+        result.distances.push_back(distance);
+        if (pos + 1 == input.size() && whole <= budget) {
+            result.accepted = true;
+        }
+    };
+    // ranked reports list the kept hits cheapest first; the whole input counts as accepted when it is one
+    auto finish = [&]() {
+        if (reportLimit_ > 0) {
+            hits.finish(result);
+            const auto whole = std::make_pair(std::size_t{0}, input.size());
+            result.accepted = std::find(result.matches.begin(), result.matches.end(), whole) != result.matches.end();
+        }
+    };
+
+    if (words == 1) {
+        // the whole column fits one word, so it stays in registers
+        std::uint64_t pv = ~std::uint64_t{0};
+        std::uint64_t mv = 0;
+        std::size_t score = length;
+        const auto bottom = high(0);
+        for (std::size_t pos = 0; pos < input.size(); ++pos) {
+            const auto eq = pattern_.masks[static_cast<unsigned char>(input[pos])];
+            score += advanceBlock(pv, mv, eq, 0, bottom);
+            ++result.statesVisited;
+            if (score <= budget || trace_) {
+                record(pos, 1, score);
+                if (hits.closed()) {
+                    break;
+                }
+            }
+        }
+        finish();
+        return result;
+    }
+
+    // column 0 is D[i][0] = i, so only the blocks holding a row within the budget start active
+    pv_.assign(words, ~std::uint64_t{0});
+    mv_.assign(words, 0);
+    scores_.assign(words, 0);
+    std::size_t last = budget == 0 ? 0 : (budget - 1) / kWordBits;
+    for (std::size_t block = 0; block <= last; ++block) {
+        scores_[block] = std::min((block + 1) * kWordBits, length);
+    }
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        const auto* eq = &pattern_.masks[static_cast<unsigned char>(input[pos]) * words];
+        const auto previous = scores_[last];
+        // a match may begin anywhere, so nothing enters the top row
+        int carry = 0;
+        for (std::size_t block = 0; block <= last; ++block) {
+            carry = advanceBlock(pv_[block], mv_[block], eq[block], carry, high(block));
+            scores_[block] += carry;
+        }
+        // the next block's top row can only come within the budget diagonally from this block's bottom row in
+        // the previous column; its unknown cells are taken as one more per row, which never undercuts them
+        auto assumed = previous;
+        while (last + 1 < words && assumed <= budget) {
+            ++last;
+            pv_[last] = ~std::uint64_t{0};
+            mv_[last] = 0;
+            assumed += rows(last);
+            carry = advanceBlock(pv_[last], mv_[last], eq[last], carry, high(last));
+            scores_[last] = assumed + carry;
+        }
+        result.statesVisited += last + 1;
+        const auto distance = last + 1 == words ? scores_[last] : budget + 1;
+        if (distance <= budget || trace_) {
+            record(pos, last + 1, distance);
+            if (hits.closed()) {
+                break;
+            }
+        }
+        // a block whose top row is already past the budget drops out until a later column reaches it again
+        while (last > 0 && scores_[last] >= budget + rows(last)) {
+            --last;
+        }
+    }
+    finish();
+    return result;
+}
+
+}  // namespace automata
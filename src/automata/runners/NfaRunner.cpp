@@ -1,8 +1,10 @@
 #include "automata/runners/Runners.hpp"
 
+#include <algorithm>
 #include <sstream>
+#include <utility>
 
-#include "automata/utils/StateSet.hpp"
+#include "automata/utils/RequiredFactor.hpp"
 
 namespace automata {
 namespace {
@@ -19,51 +21,88 @@ bool isAccepting(const Nfa& nfa, const std::vector<int>& states) {
 
 }  // namespace
 
-NfaRunner::NfaRunner(Nfa nfa, bool trace) : nfa_(std::move(nfa)), trace_(trace) {}
+NfaRunner::NfaRunner(Nfa nfa, bool trace)
+    : nfa_(std::move(nfa)),
+      reversed_(reverseNfa(nfa_)),
+      trace_(trace),
+      startClosure_(epsilonClosure(nfa_, {nfa_.start})),
+      reverseClosure_(epsilonClosure(reversed_, {reversed_.start})),
+      current_(reversed_.states.size()),
+      moved_(reversed_.states.size()),
+      reached_(reversed_.states.size()) {}
 
 RunResult NfaRunner::run(const std::string& input) {
     RunResult result;
-    const auto startClosure = epsilonClosure(nfa_, {nfa_.start});
     // empty input only succeeds if the epsilon closure of the start already includes an accepting state
     // e.g. pattern "" or "(|a)" that allows zero characters.
     if (input.empty()) {
-        if (isAccepting(nfa_, startClosure)) {
+        if (isAccepting(nfa_, startClosure_)) {
             result.accepted = true;
             result.matches.emplace_back(0, 0);
         }
         return result;
     }
-    bool entireMatch = false;
-    // evaluate the NFA starting from every prefix position, like sliding window matching
-    for (std::size_t start = 0; start < input.size(); ++start) {
-        auto current = startClosure;
-        if (current.empty()) {
-            break;
+    // forward pass: one state set carries every live attempt, so attempts that reach the same NFA state merge
+    // and a byte costs O(m) however many attempts are alive. Fresh attempts enter with the start closure, and
+    // every position where the set accepts ends at least one match.
+    ends_.clear();
+    current_.clear();
+    CandidateScanner candidates(nfa_.required, input);
+    auto nextStart = candidates.next(0);
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        // with no attempt alive, jump straight to the next offset the required literal leaves possible
+        if (current_.empty()) {
+            if (nextStart == CandidateScanner::npos) {
+                break;
+            }
+            pos = nextStart;
         }
-        // run the automaton through each successive symbol
-        for (std::size_t pos = start; pos < input.size(); ++pos) {
-            auto moved = move(nfa_, current, input[pos]);
-            // epsilon closure lets us follow epsilon transitions after consuming the char
-            current = epsilonClosure(nfa_, moved);
-            result.statesVisited += current.size();
-            if (trace_) {
-                std::ostringstream oss;
-                oss << "start=" << start << " pos=" << pos << " states=" << current.size();
-                result.trace.push_back({pos, oss.str()});
+        if (pos == nextStart) {
+            for (int state : startClosure_) {
+                current_.add(state);
             }
-            if (current.empty()) {
+            nextStart = candidates.next(pos + 1);
+        }
+        // epsilon closure lets us follow epsilon transitions after consuming the char
+        move(nfa_, current_.values(), input[pos], moved_);
+        epsilonClosure(nfa_, moved_.values(), reached_);
+        result.statesVisited += reached_.size();
+        if (trace_) {
+            std::ostringstream oss;
+            oss << "pos=" << pos << " states=" << reached_.size();
+            result.trace.push_back({pos, oss.str()});
+        }
+        if (isAccepting(nfa_, reached_.values())) {
+            ends_.push_back(pos + 1);
+        }
+        std::swap(current_, reached_);
+    }
+    // backward pass: run the reversed NFA from each end; every offset where it reaches the forward start begins
+    // a match ending there. A scan without matches never gets here, so it stays linear.
+    for (const auto end : ends_) {
+        current_.clear();
+        for (int state : reverseClosure_) {
+            current_.add(state);
+        }
+        for (std::size_t pos = end; pos-- > 0;) {
+            move(reversed_, current_.values(), input[pos], moved_);
+            epsilonClosure(reversed_, moved_.values(), reached_);
+            if (reached_.empty()) {
                 break;
             }
-            if (isAccepting(nfa_, current)) {
-                result.matches.push_back({start, pos + 1});
+            result.statesVisited += reached_.size();
+            if (reached_.contains(nfa_.start)) {
+                result.matches.emplace_back(pos, end);
                 // if the match spans the entire input, note the overall accept
-                if (start == 0 && pos + 1 == input.size()) {
-                    entireMatch = true;
+                if (pos == 0 && end == input.size()) {
+                    result.accepted = true;
                 }
             }
+            std::swap(current_, reached_);
         }
     }
-    result.accepted = entireMatch;
+    // matches were found end by end; report them ordered by start like a per-start scan would
+    std::sort(result.matches.begin(), result.matches.end());
     return result;
 }
 
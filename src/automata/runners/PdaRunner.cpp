@@ -1,5 +1,8 @@
 #include "automata/runners/Runners.hpp"
 
+#include "parser/Parsers.hpp"
+
+#include <algorithm>
 #include <sstream>
 #include <vector>
 #include <stack>
@@ -7,7 +10,22 @@
 
 namespace automata {
 
-PdaRunner::PdaRunner(Pda pda, bool trace) : pda_(std::move(pda)), trace_(trace) {}
+PdaRunner::PdaRunner(Pda pda, bool trace) : pda_(std::move(pda)), trace_(trace) {
+    // a PDA shaped like buildPdaStates' is exactly a depth-limited bracket check
+    if (pda_.start == 0 && !pda_.states.empty()) {
+        const auto canonical = buildPdaStates(pda_.states.size() - 1);
+        bracketsOnly_ = std::equal(pda_.states.begin(), pda_.states.end(), canonical.states.begin(),
+                                   [](const PdaState& a, const PdaState& b) {
+                                       return a.accept == b.accept &&
+                                              std::equal(a.transitions.begin(), a.transitions.end(),
+                                                         b.transitions.begin(), b.transitions.end(),
+                                                         [](const PdaTransition& x, const PdaTransition& y) {
+                                                             return x.symbol == y.symbol && x.to == y.to &&
+                                                                    x.operation == y.operation;
+                                                         });
+                                   });
+    }
+}
 
 bool isValidBasePair(char b1, char b2) {
     b1 = std::toupper(b1);
@@ -50,20 +68,14 @@ RunResult PdaRunner::run(const std::string& input) {
             return result;
         }
         
-        // Validate parentheses balance
-        int balance = 0;
-        for (char c : rnaSecondary_) {
-            if (c == '(') balance++;
-            else if (c == ')') {
-                balance--;
-                if (balance < 0) {
-                    result.accepted = false;
-                    result.rnaParenthesesValid = false;
-                    return result;
-                }
-            }
+        // Validate parentheses balance (other characters are ignored)
+        const auto balance = DotBracketValidator().scan(rnaSecondary_, false);
+        if (balance.stop != DotBracketScan::npos) {
+            result.accepted = false;
+            result.rnaParenthesesValid = false;
+            return result;
         }
-        result.rnaParenthesesValid = (balance == 0);
+        result.rnaParenthesesValid = (balance.depth == 0);
         
         if (!result.rnaParenthesesValid) {
             result.accepted = false;
@@ -100,6 +112,23 @@ RunResult PdaRunner::run(const std::string& input) {
     }
     
     // Standard PDA mode
+    // without a trace the bracket PDA is one vectorized scan: it stops where the PDA would have no move, and
+    // reports the same visited count and depth
+    if (bracketsOnly_ && !trace_) {
+        const auto scan = DotBracketValidator().scan(input, true, pda_.states.size() - 1);
+        result.stackDepth = scan.maxDepth;
+        if (scan.stop != DotBracketScan::npos) {
+            result.statesVisited = scan.stop + 1;
+            return result;
+        }
+        result.statesVisited = input.size();
+        if (scan.depth == 0) {
+            result.accepted = true;
+            result.matches.push_back({0, input.size()});
+        }
+        return result;
+    }
+
     int currentState = pda_.start;
     std::size_t stackDepth = 0;
     
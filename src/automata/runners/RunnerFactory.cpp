@@ -16,25 +16,163 @@ RunnerPtr RunnerFactory::create(const AutomatonPlan& plan, const RegexParser& pa
             }
             return std::make_unique<NfaRunner>(std::move(nfa), plan.spec.trace);
         }
+        case AutomatonKind::ShiftAnd: {
+            // bit-parallel position automaton: no determinization, every live position fits in one word
+            GlushkovBuilder glushkovBuilder(parser);
+            auto automaton = glushkovBuilder.build(plan.spec.pattern);
+            if (snapshot) {
+                snapshot->kind = AutomatonKind::ShiftAnd;
+                snapshot->automaton = nfaBuilder.build(plan.spec.pattern);
+            }
+            return std::make_unique<ShiftAndRunner>(std::move(automaton), plan.spec.trace);
+        }
         case AutomatonKind::Dfa: {
             // build the DFA via intermediate NFA and dedicated builder logic
             auto nfa = nfaBuilder.build(plan.spec.pattern);
             DfaBuilder dfaBuilder;
-            auto dfa = dfaBuilder.build(nfa);
+            const bool leftmostLongest = plan.spec.semantics == MatchSemantics::LeftmostLongest;
+            const auto maxStates = plan.spec.maxDfaStates;
+            try {
+                auto dfa = dfaBuilder.build(nfa, maxStates);
+                const auto rawStates = dfa.states.size();
+                // merge equivalent states so the scanned table is as small as possible
+                if (plan.spec.minimizeDfa) {
+                    dfa = dfaBuilder.minimize(dfa);
+                }
+                // one DFA finds where matches end, one run backwards recovers where they start
+                Dfa forward;
+                Dfa reverse;
+                if (leftmostLongest) {
+                    forward = dfaBuilder.minimize(dfaBuilder.build(unanchoredNfa(nfa), maxStates));
+                    reverse = dfaBuilder.minimize(dfaBuilder.build(unanchoredNfa(reverseNfa(nfa)), maxStates));
+                }
+                // consume several symbols per lookup on the tables that scan the whole input
+                if (plan.spec.dfaStride > 1) {
+                    dfa = dfaBuilder.withStride(dfa, plan.spec.dfaStride);
+                    if (leftmostLongest) {
+                        forward = dfaBuilder.withStride(forward, plan.spec.dfaStride);
+                    }
+                }
+                // small all-intervals scans of one sequence step 16 start offsets at once with byte shuffles; an
+                // explicit stride request and traces keep the table runner, and so do several sequences, whose
+                // lookups DfaRunner::runBatch overlaps across reads
+                const bool shuffle = !leftmostLongest && !plan.spec.trace && plan.spec.dfaStride <= 1 &&
+                                     plan.spec.datasets.size() <= 1 && ShuffleDfaRunner::fits(dfa);
+                std::unique_ptr<ShuffleDfaRunner> shuffleRunner;
+                if (shuffle) {
+                    shuffleRunner = std::make_unique<ShuffleDfaRunner>(dfa);
+                }
+                if (snapshot) {
+                    snapshot->kind = AutomatonKind::Dfa;
+                    snapshot->automaton = dfa;
+                    snapshot->rawDfaStates = rawStates;
+                    snapshot->dfaStates = dfa.states.size();
+                    snapshot->dfaKernel =
+                        !shuffleRunner ? "table" : shuffleRunner->vectorized() ? "shuffle (SSSE3)" : "shuffle (scalar)";
+                }
+                if (shuffleRunner) {
+                    return shuffleRunner;
+                }
+                auto dfaRunner = std::make_unique<DfaRunner>(std::move(dfa), plan.spec.trace);
+                if (leftmostLongest) {
+                    dfaRunner->setLeftmostLongest(std::move(forward), std::move(reverse));
+                }
+                return dfaRunner;
+            } catch (const DfaStateLimitExceeded& ex) {
+                // the eager table would be too large: determinize on demand within the cache budget instead
+                if (snapshot) {
+                    snapshot->kind = AutomatonKind::LazyDfa;
+                    snapshot->automaton = nfa;
+                    snapshot->fallbackReason = std::string(ex.what()) + "; using the lazy DFA runner";
+                }
+                auto lazyRunner =
+                    std::make_unique<LazyDfaRunner>(std::move(nfa), plan.spec.dfaCacheBytes, plan.spec.trace);
+                if (leftmostLongest) {
+                    lazyRunner->setLeftmostLongest();
+                }
+                return lazyRunner;
+            }
+        }
+        case AutomatonKind::LazyDfa: {
+            // determinize on demand while scanning, bounded by the configured cache budget
+            auto nfa = nfaBuilder.build(plan.spec.pattern);
             if (snapshot) {
-                snapshot->kind = AutomatonKind::Dfa;
-                snapshot->automaton = dfa;
+                snapshot->kind = AutomatonKind::LazyDfa;
+                snapshot->automaton = nfa;
+            }
+            auto lazyRunner =
+                std::make_unique<LazyDfaRunner>(std::move(nfa), plan.spec.dfaCacheBytes, plan.spec.trace);
+            if (plan.spec.semantics == MatchSemantics::LeftmostLongest) {
+                lazyRunner->setLeftmostLongest();
             }
-            return std::make_unique<DfaRunner>(std::move(dfa), plan.spec.trace);
+            return lazyRunner;
         }
         case AutomatonKind::Efa: {
             // mismatch-tolerant sampler derived directly from regex
             EfaBuilder builder(parser);
+            // indels need the edit-distance recurrence, which Myers' bit vectors run a column per byte; it has no
+            // byte-cost cap, so it skips EfaBuilder::build and the seeds and edge layout only the simulation uses
+            if (plan.spec.distance == DistanceMetric::Edit) {
+                auto myersRunner = std::make_unique<MyersRunner>(builder.buildEditPattern(plan.spec.pattern),
+                                                                 plan.spec.mismatchBudget, plan.spec.trace);
+                myersRunner->setReportLimit(plan.spec.reportLimit);
+                if (snapshot) {
+                    // the dump still shows the pattern's NFA with the budget
+                    snapshot->kind = AutomatonKind::Efa;
+                    snapshot->automaton = Efa{nfaBuilder.build(plan.spec.pattern), plan.spec.mismatchBudget,
+                                              plan.spec.pattern, {}, {}};
+                }
+                return myersRunner;
+            }
             auto efa = builder.build(plan.spec.pattern, plan.spec.mismatchBudget);
             if (snapshot) {
                 snapshot->kind = AutomatonKind::Efa;
                 snapshot->automaton = efa;
             }
+            // long enough pigeonhole seeds let the simulation skip every start no seed lines up with, which
+            // beats any full scan on long reads; ranked reports need the simulation to tighten its budget
+            if (!efa.seeds.empty() || plan.spec.reportLimit > 0) {
+                auto efaRunner = std::make_unique<EfaRunner>(std::move(efa), plan.spec.trace);
+                efaRunner->setReportLimit(plan.spec.reportLimit);
+                return efaRunner;
+            }
+            // a plain chain of at most 64 positions runs as bit-parallel Wu-Manber, O(k) word ops per byte
+            GlushkovBuilder glushkovBuilder(parser);
+            if (glushkovBuilder.fits(plan.spec.pattern)) {
+                const auto automaton = glushkovBuilder.build(plan.spec.pattern);
+                if (WuManberRunner::fits(automaton)) {
+                    return std::make_unique<WuManberRunner>(automaton, plan.spec.mismatchBudget, plan.spec.trace);
+                }
+            }
+            // small budgets determinize the (state, mismatches) product into a table, under the DFA state cap;
+            // traces keep the simulation, whose steps report per-attempt mismatch counts
+            if (plan.spec.mismatchBudget <= EfaBuilder::kMaxDeterminizedBudget && !plan.spec.trace) {
+                try {
+                    auto dfa = builder.determinize(efa, plan.spec.maxDfaStates);
+                    const auto rawStates = dfa.states.size();
+                    if (plan.spec.minimizeDfa) {
+                        dfa = DfaBuilder().minimize(dfa);
+                    }
+                    const bool shuffle = ShuffleDfaRunner::fits(dfa);
+                    if (snapshot) {
+                        snapshot->rawDfaStates = rawStates;
+                        snapshot->dfaStates = dfa.states.size();
+                        snapshot->dfaKernel = shuffle ? "shuffle" : "table";
+                    }
+                    if (shuffle) {
+                        auto shuffleRunner = std::make_unique<ShuffleDfaRunner>(dfa);
+                        if (snapshot) {
+                            snapshot->dfaKernel = shuffleRunner->vectorized() ? "shuffle (SSSE3)" : "shuffle (scalar)";
+                        }
+                        return shuffleRunner;
+                    }
+                    return std::make_unique<DfaRunner>(std::move(dfa), false);
+                } catch (const DfaStateLimitExceeded& ex) {
+                    if (snapshot) {
+                        snapshot->fallbackReason = std::string(ex.what()) + "; simulating the EFA";
+                    }
+                }
+            }
             return std::make_unique<EfaRunner>(std::move(efa), plan.spec.trace);
         }
         case AutomatonKind::Pda: {
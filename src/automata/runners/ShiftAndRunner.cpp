@@ -0,0 +1,125 @@
+#include "automata/runners/Runners.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <sstream>
+
+#include "automata/utils/RequiredFactor.hpp"
+
+namespace automata {
+namespace {
+
+// chunk tables: entry [k * 256 + b] is the union of sets[p] over the positions p = 8k + i with bit i of b set
+std::vector<std::uint64_t> chunkTable(const std::vector<std::uint64_t>& sets, std::size_t chunks) {
+    std::vector<std::uint64_t> table(chunks * 256, 0);
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (std::size_t bits = 1; bits < 256; ++bits) {
+            // extend the entry without the lowest bit by that bit's set
+            const auto low = static_cast<std::size_t>(std::countr_zero(bits));
+            const auto position = chunk * 8 + low;
+            const auto single = position < sets.size() ? sets[position] : 0;
+            table[chunk * 256 + bits] = table[chunk * 256 + (bits & (bits - 1))] | single;
+        }
+    }
+    return table;
+}
+
+std::uint64_t unionOf(const std::vector<std::uint64_t>& table, std::size_t chunks, std::uint64_t positions) {
+    std::uint64_t result = 0;
+    for (std::size_t chunk = 0; chunk < chunks && positions != 0; ++chunk, positions >>= 8) {
+        result |= table[chunk * 256 + (positions & 0xFF)];
+    }
+    return result;
+}
+
+}  // namespace
+
+ShiftAndRunner::ShiftAndRunner(Glushkov automaton, bool trace)
+    : automaton_(std::move(automaton)), trace_(trace), chunks_((automaton_.positions + 7) / 8) {
+    // precede[q] holds every p with q in follow[p]: the follow relation of the reversed pattern
+    std::vector<std::uint64_t> precede(automaton_.positions, 0);
+    for (std::size_t p = 0; p < automaton_.positions; ++p) {
+        for (std::size_t q = 0; q < automaton_.positions; ++q) {
+            if ((automaton_.follow[p] >> q) & 1u) {
+                precede[q] |= std::uint64_t{1} << p;
+            }
+        }
+    }
+    followTable_ = chunkTable(automaton_.follow, chunks_);
+    precedeTable_ = chunkTable(precede, chunks_);
+}
+
+std::uint64_t ShiftAndRunner::followOf(std::uint64_t positions) const {
+    return unionOf(followTable_, chunks_, positions);
+}
+
+std::uint64_t ShiftAndRunner::precedeOf(std::uint64_t positions) const {
+    return unionOf(precedeTable_, chunks_, positions);
+}
+
+RunResult ShiftAndRunner::run(const std::string& input) {
+    RunResult result;
+    // like the NFA, the empty input matches only when the whole pattern is nullable
+    if (input.empty()) {
+        if (automaton_.nullable) {
+            result.accepted = true;
+            result.matches.emplace_back(0, 0);
+        }
+        return result;
+    }
+    const auto& symbols = automaton_.symbols;
+    // forward pass: one mask carries the live positions of all attempts, fresh attempts enter at `first`
+    ends_.clear();
+    CandidateScanner candidates(automaton_.required, input);
+    auto nextStart = candidates.next(0);
+    std::uint64_t active = 0;
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        // with no attempt alive, jump straight to the next offset the required literal leaves possible
+        if (active == 0) {
+            if (nextStart == CandidateScanner::npos) {
+                break;
+            }
+            pos = nextStart;
+        }
+        active = followOf(active);
+        if (pos == nextStart) {
+            active |= automaton_.first;
+            nextStart = candidates.next(pos + 1);
+        }
+        active &= symbols[static_cast<unsigned char>(input[pos])];
+        result.statesVisited += static_cast<std::size_t>(std::popcount(active));
+        if (trace_) {
+            std::ostringstream oss;
+            oss << "pos=" << pos << " positions=" << std::popcount(active);
+            result.trace.push_back({pos, oss.str()});
+        }
+        if ((active & automaton_.last) != 0) {
+            ends_.push_back(pos + 1);
+        }
+    }
+    // backward pass: walk the reversed automaton from each end; every offset reaching a first position starts
+    // a match ending there
+    for (const auto end : ends_) {
+        std::size_t pos = end - 1;
+        auto reached = automaton_.last & symbols[static_cast<unsigned char>(input[pos])];
+        while (reached != 0) {
+            result.statesVisited += static_cast<std::size_t>(std::popcount(reached));
+            if ((reached & automaton_.first) != 0) {
+                result.matches.emplace_back(pos, end);
+                if (pos == 0 && end == input.size()) {
+                    result.accepted = true;
+                }
+            }
+            if (pos == 0) {
+                break;
+            }
+            --pos;
+            reached = precedeOf(reached) & symbols[static_cast<unsigned char>(input[pos])];
+        }
+    }
+    // matches were found end by end; report them ordered by start like a per-start scan would
+    std::sort(result.matches.begin(), result.matches.end());
+    return result;
+}
+
+}  // namespace automata
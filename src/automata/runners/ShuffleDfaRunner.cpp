@@ -0,0 +1,180 @@
+#include "automata/runners/Runners.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "automata/utils/RequiredFactor.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define AUTOMATA_HAVE_SSSE3_KERNEL 1
+#endif
+
+namespace automata {
+
+ShuffleDfaRunner::ShuffleDfaRunner(const Dfa& dfa)
+    : start_(static_cast<std::uint8_t>(dfa.start)),
+      dead_(static_cast<std::uint8_t>(dfa.states.size())),
+      startAccepts_(dfa.states[dfa.start].accept),
+      required_(dfa.required),
+      kernel_(&ShuffleDfaRunner::scanBlockScalar),
+      reportsMismatches_(dfa.reportsMismatches),
+      startMismatches_(dfa.states[dfa.start].mismatches) {
+    // unused slots past the dead state also lead to the dead state, so stray lanes can never revive
+    for (auto& shuffle : shuffles_) {
+        shuffle.fill(dead_);
+    }
+    for (std::size_t state = 0; state < dfa.states.size(); ++state) {
+        accepting_[state] = dfa.states[state].accept ? 0xFF : 0x00;
+        if (reportsMismatches_ && dfa.states[state].accept) {
+            const auto mismatches = dfa.states[state].mismatches;
+            distanceBits_ = std::max<std::size_t>(distanceBits_, std::bit_width(mismatches));
+            for (std::size_t bit = 0; bit < distancePlanes_.size(); ++bit) {
+                distancePlanes_[bit][state] = ((mismatches >> bit) & 1u) != 0 ? 0xFF : 0x00;
+            }
+        }
+        for (unsigned symbol = 0; symbol < 256; ++symbol) {
+            const int next = dfa.next(static_cast<int>(state), static_cast<unsigned char>(symbol));
+            shuffles_[symbol][state] = next < 0 ? dead_ : static_cast<std::uint8_t>(next);
+        }
+    }
+#ifdef AUTOMATA_HAVE_SSSE3_KERNEL
+    if (__builtin_cpu_supports("ssse3")) {
+        kernel_ = &ShuffleDfaRunner::scanBlockSsse3;
+        vectorized_ = true;
+    }
+#endif
+}
+
+RunResult ShuffleDfaRunner::run(const std::string& input) {
+    RunResult result;
+    // shortcut: empty input matches when the start state itself is accepting
+    if (input.empty() && startAccepts_) {
+        result.accepted = true;
+        result.matches.emplace_back(0, 0);
+        if (reportsMismatches_) {
+            result.distances.push_back(startMismatches_);
+        }
+        return result;
+    }
+    const auto* bytes = reinterpret_cast<const unsigned char*>(input.data());
+    // blocks begin at a candidate start, and offsets inside a block the required literal rules out stay idle
+    CandidateScanner scanner(required_, input);
+    auto candidate = scanner.next(0);
+    while (candidate != CandidateScanner::npos) {
+        const auto base = candidate;
+        unsigned candidates = 0;
+        while (candidate != CandidateScanner::npos && candidate < base + kLanes) {
+            candidates |= 1u << (candidate - base);
+            candidate = scanner.next(candidate + 1);
+        }
+        acceptMasks_.clear();
+        const auto consumed =
+            (this->*kernel_)(bytes + base, input.size() - base, candidates, acceptMasks_, result.statesVisited);
+        // the kernel reports matches end-major; DfaRunner lists them start-major, so sort each block back
+        const auto masksPerByte = 1 + distanceBits_;
+        hits_.clear();
+        for (std::size_t t = 0; t < consumed; ++t) {
+            const auto* masks = acceptMasks_.data() + t * masksPerByte;
+            for (unsigned mask = masks[0]; mask != 0; mask &= mask - 1) {
+                const auto lane = static_cast<std::size_t>(std::countr_zero(mask));
+                std::size_t distance = 0;
+                for (std::size_t bit = 0; bit < distanceBits_; ++bit) {
+                    distance |= static_cast<std::size_t>((masks[1 + bit] >> lane) & 1u) << bit;
+                }
+                hits_.emplace_back(base + lane, base + t + 1, distance);
+            }
+        }
+        std::sort(hits_.begin(), hits_.end());
+        for (const auto& [start, end, distance] : hits_) {
+            result.matches.emplace_back(start, end);
+            if (reportsMismatches_) {
+                result.distances.push_back(distance);
+            }
+            if (start == 0 && end == input.size()) {
+                result.accepted = true;
+            }
+        }
+    }
+    return result;
+}
+
+std::size_t ShuffleDfaRunner::scanBlockScalar(const unsigned char* input, std::size_t length, unsigned candidates,
+                                              std::vector<std::uint16_t>& acceptMasks, std::size_t& visited) const {
+    std::array<std::uint8_t, kLanes> states;
+    states.fill(dead_);
+    std::size_t t = 0;
+    for (; t < length; ++t) {
+        // lane t begins its attempt at this byte when its offset is a candidate start
+        if (t < kLanes && ((candidates >> t) & 1u) != 0) {
+            states[t] = start_;
+        }
+        unsigned alive = 0;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            alive |= static_cast<unsigned>(states[lane] != dead_) << lane;
+        }
+        // stop once every attempt has died and no lane is left to start
+        if (alive == 0 && (t >= kLanes || (candidates >> t) == 0)) {
+            break;
+        }
+        visited += static_cast<std::size_t>(std::popcount(alive));
+        const auto& shuffle = shuffles_[input[t]];
+        unsigned accept = 0;
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            states[lane] = shuffle[states[lane]];
+            accept |= static_cast<unsigned>(accepting_[states[lane]] != 0) << lane;
+        }
+        acceptMasks.push_back(static_cast<std::uint16_t>(accept));
+        for (std::size_t bit = 0; bit < distanceBits_; ++bit) {
+            unsigned plane = 0;
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                plane |= static_cast<unsigned>(distancePlanes_[bit][states[lane]] != 0) << lane;
+            }
+            acceptMasks.push_back(static_cast<std::uint16_t>(plane));
+        }
+    }
+    return t;
+}
+
+#ifdef AUTOMATA_HAVE_SSSE3_KERNEL
+__attribute__((target("ssse3"))) std::size_t ShuffleDfaRunner::scanBlockSsse3(
+    const unsigned char* input, std::size_t length, unsigned candidates, std::vector<std::uint16_t>& acceptMasks,
+    std::size_t& visited) const {
+    const __m128i dead = _mm_set1_epi8(static_cast<char>(dead_));
+    const __m128i accepting = _mm_load_si128(reinterpret_cast<const __m128i*>(accepting_.data()));
+    const __m128i start = _mm_set1_epi8(static_cast<char>(start_));
+    const __m128i laneIds = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    // lanes that have not started yet hold the dead state, so they are neither counted nor reported
+    __m128i states = dead;
+    std::size_t t = 0;
+    for (; t < length; ++t) {
+        // lane t begins its attempt at this byte when its offset is a candidate start
+        if (t < kLanes && ((candidates >> t) & 1u) != 0) {
+            const __m128i lane = _mm_cmpeq_epi8(laneIds, _mm_set1_epi8(static_cast<char>(t)));
+            states = _mm_or_si128(_mm_andnot_si128(lane, states), _mm_and_si128(lane, start));
+        }
+        const auto alive = static_cast<unsigned>(~_mm_movemask_epi8(_mm_cmpeq_epi8(states, dead)) & 0xFFFF);
+        // stop once every attempt has died and no lane is left to start
+        if (alive == 0 && (t >= kLanes || (candidates >> t) == 0)) {
+            break;
+        }
+        visited += static_cast<std::size_t>(std::popcount(alive));
+        const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles_[input[t]].data()));
+        states = _mm_shuffle_epi8(shuffle, states);
+        const auto accept = static_cast<unsigned>(_mm_movemask_epi8(_mm_shuffle_epi8(accepting, states)));
+        acceptMasks.push_back(static_cast<std::uint16_t>(accept));
+        for (std::size_t bit = 0; bit < distanceBits_; ++bit) {
+            const __m128i plane = _mm_load_si128(reinterpret_cast<const __m128i*>(distancePlanes_[bit].data()));
+            acceptMasks.push_back(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_shuffle_epi8(plane, states))));
+        }
+    }
+    return t;
+}
+#else
+std::size_t ShuffleDfaRunner::scanBlockSsse3(const unsigned char* input, std::size_t length, unsigned candidates,
+                                             std::vector<std::uint16_t>& acceptMasks, std::size_t& visited) const {
+    return scanBlockScalar(input, length, candidates, acceptMasks, visited);
+}
+#endif
+
+}  // namespace automata
@@ -0,0 +1,91 @@
+#include "automata/runners/Runners.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <sstream>
+
+#include "automata/utils/RequiredFactor.hpp"
+
+namespace automata {
+
+bool WuManberRunner::fits(const Glushkov& automaton) {
+    const auto length = automaton.positions;
+    if (length == 0 || automaton.nullable || automaton.first != 1 ||
+        automaton.last != std::uint64_t{1} << (length - 1)) {
+        return false;
+    }
+    // a chain: every position is followed only by the next one
+    for (std::size_t p = 0; p < length; ++p) {
+        const auto expected = p + 1 < length ? std::uint64_t{1} << (p + 1) : 0;
+        if (automaton.follow[p] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+WuManberRunner::WuManberRunner(const Glushkov& automaton, std::size_t mismatchBudget, bool trace)
+    : length_(automaton.positions),
+      // with a budget of m or more every window of length m matches, so deeper levels add nothing
+      budget_(std::min(mismatchBudget, automaton.positions)),
+      trace_(trace),
+      lengthMask_(automaton.positions == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << automaton.positions) - 1),
+      symbols_(automaton.symbols),
+      // a substitution can break the required literal, so only exact searches may skip offsets without it
+      required_(mismatchBudget == 0 ? automaton.required : RequiredFactor{}) {}
+
+RunResult WuManberRunner::run(const std::string& input) {
+    RunResult result;
+    const auto acceptBit = std::uint64_t{1} << (length_ - 1);
+    levels_.assign(budget_ + 1, 0);
+    CandidateScanner candidates(required_, input);
+    auto nextStart = candidates.next(0);
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        // an exact search with no attempt alive jumps straight to the next offset the required literal allows
+        if (budget_ == 0 && levels_[0] == 0) {
+            if (nextStart == CandidateScanner::npos) {
+                break;
+            }
+            pos = nextStart;
+        }
+        std::uint64_t fresh = 0;
+        if (pos == nextStart) {
+            fresh = 1;
+            nextStart = candidates.next(pos + 1);
+        }
+        const auto symbol = symbols_[static_cast<unsigned char>(input[pos])];
+        // level j either extends a level-j prefix with a matching byte or a level-(j - 1) prefix with a
+        // substituted one; a fresh attempt enters as bit 0 at every candidate offset
+        std::uint64_t previous = 0;
+        for (std::size_t level = 0; level <= budget_; ++level) {
+            const auto current = levels_[level];
+            auto next = ((current << 1) | fresh) & symbol;
+            if (level > 0) {
+                next |= (previous << 1) | fresh;
+            }
+            levels_[level] = next & lengthMask_;
+            previous = current;
+        }
+        result.statesVisited += static_cast<std::size_t>(std::popcount(levels_[budget_]));
+        if (trace_) {
+            std::ostringstream oss;
+            oss << "pos=" << pos << " states=" << std::popcount(levels_[budget_]);
+            const auto best = std::find_if(levels_.begin(), levels_.end(),
+                                           [acceptBit](std::uint64_t bits) { return (bits & acceptBit) != 0; });
+            if (best != levels_.end()) {
+                oss << " bestMismatch=" << (best - levels_.begin());
+            }
+            result.trace.push_back({pos, oss.str()});
+        }
+        if ((levels_[budget_] & acceptBit) != 0) {
+            const auto start = pos + 1 - length_;
+            result.matches.emplace_back(start, pos + 1);
+            if (start == 0 && pos + 1 == input.size()) {
+                result.accepted = true;
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace automata
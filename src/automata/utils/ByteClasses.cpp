@@ -0,0 +1,55 @@
+#include "automata/utils/ByteClasses.hpp"
+
+#include <set>
+#include <string>
+
+namespace automata {
+
+ByteClasses computeByteClasses(const Nfa& nfa) {
+    // every distinct byte set an edge tests; wildcards accept all bytes and never split a class
+    std::set<std::string> sets;
+    for (const auto& state : nfa.states) {
+        for (const auto& edge : state.edges) {
+            if (edge.type == EdgeType::Literal) {
+                sets.insert(std::string(1, edge.literal));
+            } else if (edge.type == EdgeType::CharClass) {
+                sets.insert(edge.charClass);
+            }
+        }
+    }
+
+    // refine the single all-bytes class by each set: bytes stay together only if they agree on membership
+    std::array<int, 256> classOf{};
+    int count = 1;
+    for (const auto& set : sets) {
+        std::array<bool, 256> member{};
+        for (unsigned char c : set) {
+            member[c] = true;
+        }
+        std::vector<int> split(static_cast<std::size_t>(count) * 2, -1);
+        int next = 0;
+        for (int c = 0; c < 256; ++c) {
+            auto& slot = split[classOf[c] * 2 + (member[c] ? 1 : 0)];
+            if (slot < 0) {
+                slot = next++;
+            }
+            classOf[c] = slot;
+        }
+        count = next;
+    }
+
+    ByteClasses classes;
+    classes.count = static_cast<std::size_t>(count);
+    classes.representatives.assign(classes.count, 0);
+    std::vector<bool> seen(classes.count, false);
+    for (int c = 0; c < 256; ++c) {
+        classes.map[c] = static_cast<std::uint8_t>(classOf[c]);
+        if (!seen[classOf[c]]) {
+            seen[classOf[c]] = true;
+            classes.representatives[classOf[c]] = static_cast<unsigned char>(c);
+        }
+    }
+    return classes;
+}
+
+}  // namespace automata
@@ -0,0 +1,90 @@
+#include "automata/utils/CppEmitter.hpp"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace automata {
+namespace {
+
+// patterns end up in a line comment, so keep them on one line and free of trailing backslashes
+std::string commentSafe(const std::string& text) {
+    std::string safe;
+    for (char c : text) {
+        safe.push_back(c == '\n' || c == '\r' || c == '\\' ? ' ' : c);
+    }
+    return safe;
+}
+
+std::string stateLabel(int state) {
+    return "state_" + std::to_string(state);
+}
+
+}  // namespace
+
+std::string emitCppScanner(const Dfa& dfa, const std::string& pattern) {
+    std::ostringstream out;
+    out << "// generated by automata_sim --emit-cpp; do not edit\n";
+    out << "// pattern: " << commentSafe(pattern) << "\n";
+    out << "// " << dfa.states.size() << " states over " << dfa.classes.count << " byte classes\n";
+    out << "#pragma once\n\n";
+    out << "#include <cstddef>\n#include <string_view>\n#include <utility>\n#include <vector>\n\n";
+    out << "namespace automata_generated {\n\n";
+
+    out << "// byte value -> equivalence class\n";
+    out << "inline constexpr unsigned char kByteClass[256] = {";
+    for (std::size_t byte = 0; byte < 256; ++byte) {
+        out << (byte % 16 == 0 ? "\n    " : " ") << static_cast<int>(dfa.classes.map[byte]) << ",";
+    }
+    out << "\n};\n\n";
+
+    out << "// every [start, end) interval the pattern matches, ordered by start and then end\n";
+    out << "inline std::vector<std::pair<std::size_t, std::size_t>> scan(std::string_view input) {\n";
+    out << "    std::vector<std::pair<std::size_t, std::size_t>> matches;\n";
+    if (dfa.states.empty()) {
+        out << "    static_cast<void>(input);\n";
+        out << "    return matches;\n}\n\n}  // namespace automata_generated\n";
+        return out.str();
+    }
+    out << "    if (input.empty()) {\n";
+    if (dfa.states[dfa.start].accept) {
+        out << "        matches.emplace_back(0, 0);\n";
+    }
+    out << "        return matches;\n    }\n";
+    out << "    for (std::size_t start = 0; start < input.size(); ++start) {\n";
+    out << "        std::size_t pos = start;\n";
+    out << "        goto " << stateLabel(dfa.start) << ";\n";
+    for (std::size_t state = 0; state < dfa.states.size(); ++state) {
+        out << "    " << stateLabel(static_cast<int>(state)) << ":\n";
+        out << "        if (pos == input.size()) {\n            continue;\n        }\n";
+        // classes that lead to the same state share one case list
+        std::map<int, std::vector<std::size_t>> byTarget;
+        for (std::size_t symbolClass = 0; symbolClass < dfa.classes.count; ++symbolClass) {
+            const int to = dfa.transitions[state * dfa.classes.count + symbolClass];
+            if (to >= 0) {
+                byTarget[to].push_back(symbolClass);
+            }
+        }
+        out << "        switch (kByteClass[static_cast<unsigned char>(input[pos++])]) {\n";
+        for (const auto& [to, classes] : byTarget) {
+            out << "           ";
+            for (auto symbolClass : classes) {
+                out << " case " << symbolClass << ":";
+            }
+            out << "\n";
+            // matches are reported on the transition into an accepting state, just like DfaRunner
+            if (dfa.states[to].accept) {
+                out << "                matches.emplace_back(start, pos);\n";
+            }
+            out << "                goto " << stateLabel(to) << ";\n";
+        }
+        out << "            default:\n                continue;\n        }\n";
+    }
+    out << "    }\n";
+    out << "    return matches;\n}\n\n";
+    out << "}  // namespace automata_generated\n";
+    return out.str();
+}
+
+}  // namespace automata
@@ -0,0 +1,311 @@
+#include "automata/utils/RequiredFactor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace automata {
+namespace {
+
+constexpr auto kUnbounded = RequiredFactor::kUnbounded;
+
+// what a sub-expression tells us about the literals its matches contain
+struct FactorInfo {
+    std::size_t minLength{0};
+    std::size_t maxLength{0};
+    // the sub-expression matches exactly `prefix` (which then equals `suffix`) and nothing else
+    bool exact{false};
+    // literals every match starts / ends with
+    std::string prefix;
+    std::string suffix;
+    // best literal found inside the sub-expression, offsets relative to the sub-expression's match start
+    RequiredFactor best;
+};
+
+std::size_t addLengths(std::size_t a, std::size_t b) {
+    return a == kUnbounded || b == kUnbounded ? kUnbounded : a + b;
+}
+
+std::size_t window(const RequiredFactor& factor) {
+    return factor.maxOffset == kUnbounded ? kUnbounded : factor.maxOffset - factor.minOffset;
+}
+
+void consider(RequiredFactor& best, RequiredFactor candidate) {
+    if (candidate.literal.size() > best.literal.size() ||
+        (candidate.literal.size() == best.literal.size() && !candidate.literal.empty() &&
+         window(candidate) < window(best))) {
+        best = std::move(candidate);
+    }
+}
+
+// the prefix always sits at offset 0; the suffix ends where the match ends
+void considerAffixes(FactorInfo& info) {
+    consider(info.best, {info.prefix, 0, 0});
+    if (!info.suffix.empty()) {
+        const auto size = info.suffix.size();
+        const auto maxOffset = info.maxLength == kUnbounded ? kUnbounded : info.maxLength - size;
+        consider(info.best, {info.suffix, info.minLength - size, maxOffset});
+    }
+}
+
+FactorInfo literalInfo(char symbol) {
+    FactorInfo info;
+    info.minLength = 1;
+    info.maxLength = 1;
+    info.exact = true;
+    info.prefix = std::string(1, symbol);
+    info.suffix = info.prefix;
+    info.best = {info.prefix, 0, 0};
+    return info;
+}
+
+FactorInfo concat(const FactorInfo& left, const FactorInfo& right) {
+    FactorInfo info;
+    info.minLength = left.minLength + right.minLength;
+    info.maxLength = addLengths(left.maxLength, right.maxLength);
+    info.exact = left.exact && right.exact;
+    info.prefix = left.exact ? left.prefix + right.prefix : left.prefix;
+    info.suffix = right.exact ? left.suffix + right.suffix : right.suffix;
+    info.best = left.best;
+    // the right side's factor moves by however much the left side consumed
+    if (!right.best.literal.empty()) {
+        consider(info.best, {right.best.literal, right.best.minOffset + left.minLength,
+                             addLengths(right.best.maxOffset, left.maxLength)});
+    }
+    // a literal can also straddle the boundary: the left side's suffix followed by the right side's prefix
+    if (!left.suffix.empty() && !right.prefix.empty()) {
+        const auto size = left.suffix.size();
+        consider(info.best, {left.suffix + right.prefix, left.minLength - size,
+                             left.maxLength == kUnbounded ? kUnbounded : left.maxLength - size});
+    }
+    considerAffixes(info);
+    return info;
+}
+
+FactorInfo alternate(const FactorInfo& left, const FactorInfo& right) {
+    FactorInfo info;
+    info.minLength = std::min(left.minLength, right.minLength);
+    info.maxLength = std::max(left.maxLength, right.maxLength);
+    info.exact = left.exact && right.exact && left.prefix == right.prefix;
+    const auto common = std::mismatch(left.prefix.begin(), left.prefix.end(), right.prefix.begin(), right.prefix.end());
+    info.prefix.assign(left.prefix.begin(), common.first);
+    const auto commonSuffix =
+        std::mismatch(left.suffix.rbegin(), left.suffix.rend(), right.suffix.rbegin(), right.suffix.rend());
+    info.suffix.assign(commonSuffix.first.base(), left.suffix.end());
+    // both branches requiring the same literal keeps it, over the union of their windows
+    if (!left.best.literal.empty() && left.best.literal == right.best.literal) {
+        info.best = {left.best.literal, std::min(left.best.minOffset, right.best.minOffset),
+                     std::max(left.best.maxOffset, right.best.maxOffset)};
+    }
+    considerAffixes(info);
+    return info;
+}
+
+}  // namespace
+
+RequiredFactor extractRequiredFactor(const std::vector<RegexToken>& postfix) {
+    std::vector<FactorInfo> stack;
+    for (const auto& token : postfix) {
+        switch (token.type) {
+            case RegexTokenType::Literal:
+                stack.push_back(literalInfo(token.text.empty() ? '\0' : token.text.front()));
+                break;
+            case RegexTokenType::CharClass:
+            case RegexTokenType::Any: {
+                // a one-symbol class is a literal in disguise; anything wider only contributes its length
+                if (token.type == RegexTokenType::CharClass && token.text.size() == 1) {
+                    stack.push_back(literalInfo(token.text.front()));
+                    break;
+                }
+                FactorInfo info;
+                info.minLength = 1;
+                info.maxLength = 1;
+                stack.push_back(info);
+                break;
+            }
+            case RegexTokenType::Concat:
+            case RegexTokenType::Union: {
+                if (stack.size() < 2) {
+                    return {};
+                }
+                auto right = std::move(stack.back());
+                stack.pop_back();
+                auto left = std::move(stack.back());
+                stack.pop_back();
+                stack.push_back(token.type == RegexTokenType::Concat ? concat(left, right) : alternate(left, right));
+                break;
+            }
+            case RegexTokenType::Star:
+            case RegexTokenType::Question: {
+                if (stack.empty()) {
+                    return {};
+                }
+                // zero repetitions are allowed, so nothing inside is mandatory
+                FactorInfo info;
+                info.maxLength = token.type == RegexTokenType::Star ? kUnbounded : stack.back().maxLength;
+                stack.back() = info;
+                break;
+            }
+            case RegexTokenType::Plus: {
+                if (stack.empty()) {
+                    return {};
+                }
+                // the first repetition keeps its literals and their offsets; only the length becomes open-ended
+                auto& info = stack.back();
+                info.maxLength = kUnbounded;
+                if (info.exact) {
+                    info.exact = false;
+                    info.best = {};
+                }
+                considerAffixes(info);
+                break;
+            }
+        }
+    }
+    if (stack.size() != 1) {
+        return {};
+    }
+    return stack.back().best;
+}
+
+std::vector<RequiredFactor> extractSeeds(const std::vector<RegexToken>& postfix, std::size_t pieces) {
+    // the pattern's symbols in order, '\0' standing for a position that is not a single literal
+    std::string symbols;
+    std::vector<bool> literal;
+    for (const auto& token : postfix) {
+        switch (token.type) {
+            case RegexTokenType::Literal:
+                symbols.push_back(token.text.empty() ? '\0' : token.text.front());
+                literal.push_back(true);
+                break;
+            case RegexTokenType::CharClass:
+            case RegexTokenType::Any: {
+                const bool single = token.type == RegexTokenType::CharClass && token.text.size() == 1;
+                symbols.push_back(single ? token.text.front() : '\0');
+                literal.push_back(single);
+                break;
+            }
+            case RegexTokenType::Concat:
+                break;
+            default:
+                // alternation or repetition: match lengths vary, so pieces have no fixed offset
+                return {};
+        }
+    }
+    // maximal literal runs as (offset, length)
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    for (std::size_t i = 0; i < literal.size();) {
+        if (!literal[i]) {
+            ++i;
+            continue;
+        }
+        const auto begin = i;
+        while (i < literal.size() && literal[i]) {
+            ++i;
+        }
+        runs.emplace_back(begin, i - begin);
+    }
+    // the longest length every piece can have while the runs still yield enough of them
+    auto countPieces = [&](std::size_t length) {
+        std::size_t count = 0;
+        for (const auto& run : runs) {
+            count += run.second / length;
+        }
+        return count;
+    };
+    if (pieces == 0 || countPieces(1) < pieces) {
+        return {};
+    }
+    std::size_t length = 1;
+    while (countPieces(length + 1) >= pieces) {
+        ++length;
+    }
+    // merge surplus pieces inside the runs holding the most, which lengthens the pieces that remain
+    std::vector<std::size_t> counts;
+    std::size_t total = 0;
+    for (const auto& run : runs) {
+        counts.push_back(run.second / length);
+        total += counts.back();
+    }
+    while (total > pieces) {
+        --*std::max_element(counts.begin(), counts.end());
+        --total;
+    }
+    std::vector<RequiredFactor> seeds;
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        auto [offset, size] = runs[r];
+        for (std::size_t piece = 0; piece < counts[r]; ++piece) {
+            // spread the run evenly; earlier pieces take the remainder
+            const auto remaining = counts[r] - piece;
+            const auto pieceSize = (size + remaining - 1) / remaining;
+            seeds.push_back({symbols.substr(offset, pieceSize), offset, offset});
+            offset += pieceSize;
+            size -= pieceSize;
+        }
+    }
+    return seeds;
+}
+
+CandidateScanner::CandidateScanner(const RequiredFactor& factor, std::string_view input)
+    : factor_(&factor), input_(input) {}
+
+std::size_t CandidateScanner::find(std::size_t from) const {
+    if (from + factor_->literal.size() > input_.size()) {
+        return npos;
+    }
+#if defined(__GLIBC__)
+    // glibc's memmem is vectorized and far quicker than a first-byte memchr on a four-letter alphabet
+    const auto& literal = factor_->literal;
+    const void* hit = memmem(input_.data() + from, input_.size() - from, literal.data(), literal.size());
+    return hit == nullptr ? npos : static_cast<std::size_t>(static_cast<const char*>(hit) - input_.data());
+#else
+    return input_.find(factor_->literal, from);
+#endif
+}
+
+std::size_t CandidateScanner::next(std::size_t from) {
+    if (factor_->literal.empty()) {
+        return from < input_.size() ? from : npos;
+    }
+    while (from < input_.size()) {
+        const auto earliest = from + factor_->minOffset;
+        if (earliest > input_.size()) {
+            return npos;
+        }
+        // the cached hit stays the first occurrence at or after `earliest` while it is not behind it
+        if (!searched_ || hit_ < earliest) {
+            hit_ = find(earliest);
+            searched_ = true;
+        }
+        if (hit_ == npos) {
+            return npos;
+        }
+        // too far ahead for this start: the first start this occurrence can serve is hit - maxOffset
+        if (factor_->maxOffset != RequiredFactor::kUnbounded && hit_ - from > factor_->maxOffset) {
+            from = hit_ - factor_->maxOffset;
+            continue;
+        }
+        return from;
+    }
+    return npos;
+}
+
+SeedScanner::SeedScanner(const std::vector<RequiredFactor>& seeds, std::string_view input) : size_(input.size()) {
+    scanners_.reserve(seeds.size());
+    for (const auto& seed : seeds) {
+        scanners_.emplace_back(seed, input);
+    }
+}
+
+std::size_t SeedScanner::next(std::size_t from) {
+    if (scanners_.empty()) {
+        return from < size_ ? from : npos;
+    }
+    // every scanner caches its last hit, so the merge costs one comparison per seed between hits
+    auto earliest = npos;
+    for (auto& scanner : scanners_) {
+        earliest = std::min(earliest, scanner.next(from));
+    }
+    return earliest;
+}
+
+}  // namespace automata
@@ -1,69 +1,116 @@
 #include "automata/utils/StateSet.hpp"
 
-#include <queue>
-
 namespace automata {
+namespace {
+
+// breadth-first search over epsilon edges; used to build the closure tables and for NFAs without them.
+// the members of `closure` double as the work queue since every state is appended exactly once.
+void searchEpsilonClosure(const Nfa& nfa, const std::vector<int>& states, StateSet& closure) {
+    closure.clear();
+    for (int state : states) {
+        closure.add(state);
+    }
+    for (std::size_t i = 0; i < closure.size(); ++i) {
+        const int state = closure.values()[i];
+        for (const auto& edge : nfa.states[state].edges) {
+            if (edge.type == EdgeType::Epsilon) {
+                closure.add(edge.to);
+            }
+        }
+    }
+}
 
-StateSet::StateSet(std::size_t size) : visited_(size, false) {}
+bool hasClosureTable(const Nfa& nfa) {
+    return nfa.closureOffsets.size() == nfa.states.size() + 1;
+}
+
+}  // namespace
+
+StateSet::StateSet(std::size_t size) : sparse_(size, 0) {
+    values_.reserve(size);
+}
 
 void StateSet::add(int state) {
-    if (state < 0 || static_cast<std::size_t>(state) >= visited_.size()) {
+    if (state < 0 || static_cast<std::size_t>(state) >= sparse_.size() || contains(state)) {
         return;
     }
-    if (!visited_[state]) {
-        visited_[state] = true;
-        values_.push_back(state);
-    }
+    sparse_[state] = static_cast<int>(values_.size());
+    values_.push_back(state);
 }
 
 bool StateSet::contains(int state) const {
-    return state >= 0 && static_cast<std::size_t>(state) < visited_.size() && visited_[state];
+    if (state < 0 || static_cast<std::size_t>(state) >= sparse_.size()) {
+        return false;
+    }
+    const auto index = static_cast<std::size_t>(sparse_[state]);
+    return index < values_.size() && values_[index] == state;
 }
 
-std::vector<int> epsilonClosure(const Nfa& nfa, const std::vector<int>& states) {
+void computeEpsilonClosures(Nfa& nfa) {
     StateSet closure(nfa.states.size());
-    std::queue<int> q;
-    for (int state : states) {
-        closure.add(state);
-        q.push(state);
+    nfa.closureOffsets.assign(1, 0);
+    nfa.closureStates.clear();
+    for (std::size_t state = 0; state < nfa.states.size(); ++state) {
+        searchEpsilonClosure(nfa, {static_cast<int>(state)}, closure);
+        nfa.closureStates.insert(nfa.closureStates.end(), closure.values().begin(), closure.values().end());
+        nfa.closureOffsets.push_back(nfa.closureStates.size());
     }
-    while (!q.empty()) {
-        int state = q.front();
-        q.pop();
-        for (const auto& edge : nfa.states[state].edges) {
-            if (edge.type == EdgeType::Epsilon && !closure.contains(edge.to)) {
-                closure.add(edge.to);
-                q.push(edge.to);
-            }
+}
+
+void epsilonClosure(const Nfa& nfa, const std::vector<int>& states, StateSet& out) {
+    if (!hasClosureTable(nfa)) {
+        searchEpsilonClosure(nfa, states, out);
+        return;
+    }
+    // union the precomputed closures of each member instead of walking epsilon edges again
+    out.clear();
+    for (int state : states) {
+        if (out.contains(state)) {
+            continue;
+        }
+        for (auto i = nfa.closureOffsets[state]; i < nfa.closureOffsets[state + 1]; ++i) {
+            out.add(nfa.closureStates[i]);
         }
     }
-    auto values = closure.values();
-    return values;
 }
 
-std::vector<int> move(const Nfa& nfa, const std::vector<int>& states, char symbol) {
-    StateSet destination(nfa.states.size());
+bool consumesSymbol(EdgeType type) {
+    return type == EdgeType::Literal || type == EdgeType::Any || type == EdgeType::CharClass;
+}
+
+bool edgeAccepts(const Edge& edge, char symbol) {
+    switch (edge.type) {
+        case EdgeType::Literal:
+            return edge.literal == symbol;
+        case EdgeType::Any:
+            return true;
+        case EdgeType::CharClass:
+            return edge.charClass.find(symbol) != std::string::npos;
+        default:
+            return false;
+    }
+}
+
+void move(const Nfa& nfa, const std::vector<int>& states, char symbol, StateSet& out) {
+    out.clear();
     for (int state : states) {
         for (const auto& edge : nfa.states[state].edges) {
-            bool matches = false;
-            switch (edge.type) {
-                case EdgeType::Literal:
-                    matches = edge.literal == symbol;
-                    break;
-                case EdgeType::Any:
-                    matches = true;
-                    break;
-                case EdgeType::CharClass:
-                    matches = edge.charClass.find(symbol) != std::string::npos;
-                    break;
-                default:
-                    break;
-            }
-            if (matches) {
-                destination.add(edge.to);
+            if (edgeAccepts(edge, symbol)) {
+                out.add(edge.to);
             }
         }
     }
+}
+
+std::vector<int> epsilonClosure(const Nfa& nfa, const std::vector<int>& states) {
+    StateSet closure(nfa.states.size());
+    epsilonClosure(nfa, states, closure);
+    return closure.values();
+}
+
+std::vector<int> move(const Nfa& nfa, const std::vector<int>& states, char symbol) {
+    StateSet destination(nfa.states.size());
+    move(nfa, states, symbol, destination);
     return destination.values();
 }
 
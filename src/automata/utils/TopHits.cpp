@@ -0,0 +1,47 @@
+#include "automata/utils/TopHits.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace automata {
+
+TopHits::TopHits(std::size_t limit, std::size_t budget) : limit_(limit), budget_(budget) {}
+
+void TopHits::add(std::size_t start, std::size_t end, std::size_t cost) {
+    if (closed_ || cost > budget_) {
+        return;
+    }
+    kept_.emplace(cost, found_++, start, end);
+    if (kept_.size() > limit_) {
+        kept_.pop();
+    }
+    if (kept_.size() == limit_) {
+        // only a strictly cheaper hit can displace the worst one kept
+        const auto worst = std::get<0>(kept_.top());
+        if (worst == 0) {
+            closed_ = true;
+        } else {
+            budget_ = worst - 1;
+        }
+    }
+}
+
+void TopHits::finish(RunResult& result) {
+    std::vector<Hit> hits;
+    hits.reserve(kept_.size());
+    for (; !kept_.empty(); kept_.pop()) {
+        hits.push_back(kept_.top());
+    }
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        return std::make_tuple(std::get<0>(a), std::get<2>(a), std::get<3>(a)) <
+               std::make_tuple(std::get<0>(b), std::get<2>(b), std::get<3>(b));
+    });
+    result.matches.clear();
+    result.distances.clear();
+    for (const auto& [cost, order, start, end] : hits) {
+        result.matches.emplace_back(start, end);
+        result.distances.push_back(cost);
+    }
+}
+
+}  // namespace automata
@@ -1,5 +1,7 @@
 #include "modes/ModeDispatcher.hpp"
 
+#include "modes/ModeHeuristics.hpp"
+
 namespace automata {
 
 AutomatonPlan ModeDispatcher::decide(const PatternSpec& spec) const {
@@ -12,6 +14,12 @@ AutomatonPlan ModeDispatcher::decide(const PatternSpec& spec) const {
         case ModePreference::Dfa:
             plan.kind = AutomatonKind::Dfa;
             return plan;
+        case ModePreference::LazyDfa:
+            plan.kind = AutomatonKind::LazyDfa;
+            return plan;
+        case ModePreference::ShiftAnd:
+            plan.kind = AutomatonKind::ShiftAnd;
+            return plan;
         case ModePreference::Efa:
             plan.kind = AutomatonKind::Efa;
             return plan;
@@ -27,6 +35,12 @@ AutomatonPlan ModeDispatcher::decide(const PatternSpec& spec) const {
         plan.kind = AutomatonKind::Pda;
     } else if (spec.mismatchBudget > 0) {
         plan.kind = AutomatonKind::Efa;
+    } else if (spec.semantics == MatchSemantics::AllIntervals && fitsShiftAnd(spec.pattern)) {
+        // short patterns run bit-parallel without any determinization cost
+        plan.kind = AutomatonKind::ShiftAnd;
+    } else if (spec.semantics == MatchSemantics::LeftmostLongest) {
+        // only the DFA runners recover match starts; a capped table still falls back to the lazy runner
+        plan.kind = AutomatonKind::Dfa;
     } else {
         plan.kind = AutomatonKind::Nfa;
     }
@@ -1,5 +1,8 @@
 #include "modes/ModeHeuristics.hpp"
 
+#include "automata/builders/Builders.hpp"
+#include "parser/Parsers.hpp"
+
 namespace automata {
 
 bool shouldDeterminize(std::size_t patternLength, std::size_t inputLength) {
@@ -12,4 +15,9 @@ bool shouldDeterminize(std::size_t patternLength, std::size_t inputLength) {
     return inputLength > patternLength * 10;
 }
 
+bool fitsShiftAnd(const std::string& pattern) {
+    RegexParser parser;
+    return GlushkovBuilder(parser).fits(pattern);
+}
+
 }  // namespace automata
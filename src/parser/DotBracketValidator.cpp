@@ -1,45 +1,304 @@
 #include "parser/Parsers.hpp"
 
-#include <stack>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUTOMATA_HAVE_AVX2_KERNEL 1
+#endif
 
 namespace automata {
+namespace {
 
-// validates if sequence is balanced by incremending and decrementing balance variable and checking
-bool DotBracketValidator::validate(const std::string& sequence) const {
-    std::size_t balance = 0;
-    for (char c : sequence) {
-        if (c == '(') {
-            ++balance;
-        } else if (c == ')') {
-            if (balance == 0) {
-                return false;
+constexpr std::size_t kBlock = 32;
+
+// +1 for '(', -1 for ')', 0 for everything else
+constexpr std::array<std::int8_t, 256> kStep = [] {
+    std::array<std::int8_t, 256> step{};
+    step['('] = 1;
+    step[')'] = -1;
+    return step;
+}();
+
+constexpr std::array<bool, 256> kStructure = [] {
+    std::array<bool, 256> structure{};
+    structure['('] = structure[')'] = structure['.'] = true;
+    return structure;
+}();
+
+// both kernels scan [0, length) from `depth`, raising `maxDepth`; they return the first position that breaks the
+// structure (npos when none does) with `depth` and `maxDepth` covering the bytes before it
+using Kernel = std::size_t (*)(const unsigned char*, std::size_t, bool, std::size_t, std::size_t&, std::size_t&);
+
+std::size_t scanScalar(const unsigned char* data, std::size_t length, bool strict, std::size_t limit,
+                       std::size_t& depth, std::size_t& maxDepth) {
+    for (std::size_t i = 0; i < length; ++i) {
+        if (strict && !kStructure[data[i]]) {
+            return i;
+        }
+        const auto step = kStep[data[i]];
+        if ((step < 0 && depth == 0) || (step > 0 && depth == limit)) {
+            return i;
+        }
+        depth += static_cast<std::size_t>(static_cast<std::ptrdiff_t>(step));
+        maxDepth = std::max(maxDepth, depth);
+    }
+    return DotBracketScan::npos;
+}
+
+// the parallel pass summarizes chunks without stopping; foreign bytes count as 0 and only the first is recorded
+using SummaryKernel = DotBracketSummary (*)(const unsigned char*, std::size_t);
+
+DotBracketSummary summarizeScalar(const unsigned char* data, std::size_t length) {
+    DotBracketSummary summary;
+    summary.length = length;
+    for (std::size_t i = 0; i < length; ++i) {
+        if (!kStructure[data[i]] && summary.foreign == DotBracketScan::npos) {
+            summary.foreign = i;
+        }
+        summary.delta += kStep[data[i]];
+        summary.minPrefix = std::min(summary.minPrefix, summary.delta);
+        summary.maxPrefix = std::max(summary.maxPrefix, summary.delta);
+    }
+    return summary;
+}
+
+#ifdef AUTOMATA_HAVE_AVX2_KERNEL
+__attribute__((target("avx2"))) int reduceMin(__m256i v) {
+    auto m = _mm256_castsi256_si128(_mm256_min_epi8(v, _mm256_permute2x128_si256(v, v, 1)));
+    m = _mm_min_epi8(m, _mm_srli_si128(m, 8));
+    m = _mm_min_epi8(m, _mm_srli_si128(m, 4));
+    m = _mm_min_epi8(m, _mm_srli_si128(m, 2));
+    m = _mm_min_epi8(m, _mm_srli_si128(m, 1));
+    return static_cast<std::int8_t>(_mm_cvtsi128_si32(m));
+}
+
+__attribute__((target("avx2"))) int reduceMax(__m256i v) {
+    auto m = _mm256_castsi256_si128(_mm256_max_epi8(v, _mm256_permute2x128_si256(v, v, 1)));
+    m = _mm_max_epi8(m, _mm_srli_si128(m, 8));
+    m = _mm_max_epi8(m, _mm_srli_si128(m, 4));
+    m = _mm_max_epi8(m, _mm_srli_si128(m, 2));
+    m = _mm_max_epi8(m, _mm_srli_si128(m, 1));
+    return static_cast<std::int8_t>(_mm_cvtsi128_si32(m));
+}
+
+// the masks are -1 where they hit, so closes - opens is +1 for '(' and -1 for ')'; prefix sums within each 16-byte
+// half, then the low half's total carried into the high half, stay within [-32, 32]
+__attribute__((target("avx2"))) __m256i prefixSteps(__m256i opens, __m256i closes) {
+    auto sums = _mm256_sub_epi8(closes, opens);
+    sums = _mm256_add_epi8(sums, _mm256_slli_si256(sums, 1));
+    sums = _mm256_add_epi8(sums, _mm256_slli_si256(sums, 2));
+    sums = _mm256_add_epi8(sums, _mm256_slli_si256(sums, 4));
+    sums = _mm256_add_epi8(sums, _mm256_slli_si256(sums, 8));
+    const auto lowTotal = _mm256_shuffle_epi8(_mm256_permute2x128_si256(sums, sums, 0x08), _mm256_set1_epi8(15));
+    return _mm256_add_epi8(sums, lowTotal);
+}
+
+__attribute__((target("avx2"))) std::size_t scanAvx2(const unsigned char* data, std::size_t length, bool strict,
+                                                     std::size_t limit, std::size_t& depth, std::size_t& maxDepth) {
+    const auto open = _mm256_set1_epi8('(');
+    const auto close = _mm256_set1_epi8(')');
+    const auto dot = _mm256_set1_epi8('.');
+    std::size_t i = 0;
+    for (; i + kBlock <= length; i += kBlock) {
+        const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const auto opens = _mm256_cmpeq_epi8(bytes, open);
+        const auto closes = _mm256_cmpeq_epi8(bytes, close);
+        if (strict) {
+            const auto known = _mm256_or_si256(_mm256_or_si256(opens, closes), _mm256_cmpeq_epi8(bytes, dot));
+            if (static_cast<std::uint32_t>(_mm256_movemask_epi8(known)) != 0xFFFFFFFFu) {
+                break;
             }
-            --balance;
-        } else if (c != '.') {
-            return false;
         }
+        const auto sums = prefixSteps(opens, closes);
+        const auto low = reduceMin(sums);
+        const auto high = reduceMax(sums);
+        // a block that leaves [0, limit] is rescanned a byte at a time to find where
+        const bool underflow = low < 0 && depth < static_cast<std::size_t>(-low);
+        const bool overflow = high > 0 && limit - depth < static_cast<std::size_t>(high);
+        if (underflow || overflow) {
+            break;
+        }
+        maxDepth = std::max(maxDepth, depth + static_cast<std::size_t>(std::max(high, 0)));
+        const auto net = static_cast<std::int8_t>(_mm256_extract_epi8(sums, 31));
+        depth += static_cast<std::size_t>(static_cast<std::ptrdiff_t>(net));
     }
-    return balance == 0;
+    const auto stop = scanScalar(data + i, length - i, strict, limit, depth, maxDepth);
+    return stop == DotBracketScan::npos ? stop : i + stop;
 }
 
-std::size_t DotBracketValidator::getMaxDepth(const std::string& sequence) const {
-    std::size_t currentDepth = 0;
-    std::size_t maxDepth = 0;
-    for (char c : sequence) {
-        if (c == '(') {
-            ++currentDepth;
-            if (currentDepth > maxDepth) {
-                maxDepth = currentDepth;
+__attribute__((target("avx2"))) DotBracketSummary summarizeAvx2(const unsigned char* data, std::size_t length) {
+    const auto open = _mm256_set1_epi8('(');
+    const auto close = _mm256_set1_epi8(')');
+    const auto dot = _mm256_set1_epi8('.');
+    DotBracketSummary summary;
+    std::size_t i = 0;
+    for (; i + kBlock <= length; i += kBlock) {
+        const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const auto opens = _mm256_cmpeq_epi8(bytes, open);
+        const auto closes = _mm256_cmpeq_epi8(bytes, close);
+        if (summary.foreign == DotBracketScan::npos) {
+            const auto known = _mm256_or_si256(_mm256_or_si256(opens, closes), _mm256_cmpeq_epi8(bytes, dot));
+            const auto unknown = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(known));
+            if (unknown != 0) {
+                summary.foreign = i + static_cast<std::size_t>(__builtin_ctz(unknown));
             }
-        } else if (c == ')') {
-            if (currentDepth == 0) {
-                return 0;  // Invalid: closing without opening
+        }
+        const auto sums = prefixSteps(opens, closes);
+        summary.minPrefix = std::min<std::ptrdiff_t>(summary.minPrefix, summary.delta + reduceMin(sums));
+        summary.maxPrefix = std::max<std::ptrdiff_t>(summary.maxPrefix, summary.delta + reduceMax(sums));
+        summary.delta += static_cast<std::int8_t>(_mm256_extract_epi8(sums, 31));
+    }
+    summary.length = i;
+    return combineSummaries(summary, summarizeScalar(data + i, length - i));
+}
+#endif
+
+Kernel pickKernel() {
+#ifdef AUTOMATA_HAVE_AVX2_KERNEL
+    if (__builtin_cpu_supports("avx2")) {
+        return &scanAvx2;
+    }
+#endif
+    return &scanScalar;
+}
+
+SummaryKernel pickSummaryKernel() {
+#ifdef AUTOMATA_HAVE_AVX2_KERNEL
+    if (__builtin_cpu_supports("avx2")) {
+        return &summarizeAvx2;
+    }
+#endif
+    return &summarizeScalar;
+}
+
+// the CPU is probed once; `scalar` keeps the byte-at-a-time loops selectable for tests
+Kernel scanKernel(bool scalar) {
+    static const Kernel detected = pickKernel();
+    return scalar ? &scanScalar : detected;
+}
+
+SummaryKernel summaryKernel(bool scalar) {
+    static const SummaryKernel detected = pickSummaryKernel();
+    return scalar ? &summarizeScalar : detected;
+}
+
+}  // namespace
+
+DotBracketSummary combineSummaries(const DotBracketSummary& left, const DotBracketSummary& right) {
+    DotBracketSummary combined;
+    combined.length = left.length + right.length;
+    combined.delta = left.delta + right.delta;
+    combined.minPrefix = std::min(left.minPrefix, left.delta + right.minPrefix);
+    combined.maxPrefix = std::max(left.maxPrefix, left.delta + right.maxPrefix);
+    if (left.foreign != DotBracketScan::npos) {
+        combined.foreign = left.foreign;
+    } else if (right.foreign != DotBracketScan::npos) {
+        combined.foreign = left.length + right.foreign;
+    }
+    return combined;
+}
+
+// balanced when nothing breaks the structure and every bracket is closed at the end
+bool DotBracketValidator::validate(const std::string& sequence) const {
+    const auto result = scan(sequence);
+    return result.stop == DotBracketScan::npos && result.depth == 0;
+}
+
+// other characters are ignored; a closing bracket without an opening one makes the depth 0
+std::size_t DotBracketValidator::getMaxDepth(const std::string& sequence) const {
+    const auto result = scan(sequence, false);
+    return result.stop == DotBracketScan::npos ? result.maxDepth : 0;
+}
+
+DotBracketScan DotBracketValidator::scan(std::string_view structure, bool strict, std::size_t depthLimit) const {
+    const auto kernel = scanKernel(scalar_);
+    if (structure.size() >= kParallelThreshold) {
+        const auto threads = std::min<std::size_t>(std::thread::hardware_concurrency(), structure.size() / kMinChunk);
+        if (threads > 1) {
+            return scanChunked(structure, threads, strict, depthLimit);
+        }
+    }
+    DotBracketScan result;
+    result.stop = kernel(reinterpret_cast<const unsigned char*>(structure.data()), structure.size(), strict,
+                         depthLimit, result.depth, result.maxDepth);
+    return result;
+}
+
+DotBracketScan DotBracketValidator::scanChunked(std::string_view structure, std::size_t threads, bool strict,
+                                                std::size_t depthLimit) const {
+    const auto kernel = scanKernel(scalar_);
+    const auto* data = reinterpret_cast<const unsigned char*>(structure.data());
+    const auto chunks = std::max<std::size_t>(1, std::min(threads, structure.size()));
+    const auto chunkLength = (structure.size() + chunks - 1) / chunks;
+    auto bounds = [&](std::size_t chunk) {
+        const auto begin = std::min(chunk * chunkLength, structure.size());
+        return std::make_pair(begin, std::min(begin + chunkLength, structure.size()));
+    };
+
+    std::vector<DotBracketSummary> summaries(chunks);
+    {
+        auto summarizeChunk = [&](std::size_t chunk) {
+            const auto [begin, end] = bounds(chunk);
+            summaries[chunk] = summarize(structure.substr(begin, end - begin));
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+        std::size_t spawned = 1;
+        try {
+            for (; spawned < chunks; ++spawned) {
+                workers.emplace_back(summarizeChunk, spawned);
             }
-            --currentDepth;
+        } catch (const std::system_error&) {
+            // out of threads: the workers already started must still be joined, and the chunks left without
+            // one are summarized on this thread instead
+        }
+        for (std::size_t chunk = spawned; chunk < chunks; ++chunk) {
+            summarizeChunk(chunk);
         }
-        // Ignore '.' and other characters
+        summarizeChunk(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // exclusive scan over the summaries: the depth each chunk starts at, stopping at the first chunk that can
+    // underflow, exceed the limit or (when strict) hold a foreign byte; the sequential kernel pins down where
+    DotBracketScan result;
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        const auto& summary = summaries[chunk];
+        const auto start = static_cast<std::ptrdiff_t>(result.depth);
+        const bool underflow = start + summary.minPrefix < 0;
+        const bool overflow = static_cast<std::size_t>(start + summary.maxPrefix) > depthLimit;
+        const bool foreign = strict && summary.foreign != DotBracketScan::npos;
+        if (underflow || overflow || foreign) {
+            const auto [begin, end] = bounds(chunk);
+            const auto stop = kernel(data + begin, end - begin, strict, depthLimit, result.depth, result.maxDepth);
+            result.stop = stop == DotBracketScan::npos ? stop : begin + stop;
+            return result;
+        }
+        result.maxDepth = std::max(result.maxDepth, static_cast<std::size_t>(start + summary.maxPrefix));
+        result.depth = static_cast<std::size_t>(start + summary.delta);
+    }
+    return result;
+}
+
+DotBracketSummary DotBracketValidator::summarize(std::string_view chunk) const {
+    const auto kernel = summaryKernel(scalar_);
+    return kernel(reinterpret_cast<const unsigned char*>(chunk.data()), chunk.size());
+}
+
+std::size_t DotBracketValidator::firstError(std::string_view structure) const {
+    const auto result = scan(structure);
+    if (result.stop != DotBracketScan::npos) {
+        return result.stop;
     }
-    return maxDepth;
+    return result.depth == 0 ? DotBracketScan::npos : structure.size();
 }
 
 }  // namespace automata
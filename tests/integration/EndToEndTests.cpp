@@ -1,4 +1,6 @@
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "PatternSpec.hpp"
 #include "automata/runners/Runners.hpp"
@@ -17,10 +19,57 @@ void runIntegrationTests() {
     spec.datasets = {"ACGTTACG"};
     spec.requestedMode = ModePreference::Auto;
     auto plan = dispatcher.decide(spec);
+    // short exact patterns go to the bit-parallel engine
+    assert(plan.kind == AutomatonKind::ShiftAnd);
     auto runner = factory.create(plan, parser);
     auto result = runner->run(spec.datasets.front());
     assert(!result.matches.empty());
 
+    PatternSpec searchSpec = spec;
+    searchSpec.pattern = "ACGT|G";
+    searchSpec.requestedMode = ModePreference::Dfa;
+    searchSpec.semantics = MatchSemantics::LeftmostLongest;
+    plan = dispatcher.decide(searchSpec);
+    auto searchRunner = factory.create(plan, parser);
+    // the leftmost match wins even though the shorter G match ends first
+    const std::vector<std::pair<std::size_t, std::size_t>> searchExpected{{0, 4}, {5, 6}, {6, 7}};
+    assert(searchRunner->run("ACGTAGGC").matches == searchExpected);
+
+    // auto and lazy-dfa honour leftmost-longest too instead of reporting every overlapping interval
+    searchSpec.pattern = "A(CG|TT)*";
+    const std::vector<std::pair<std::size_t, std::size_t>> longestExpected{{1, 6}, {6, 9}, {9, 10}};
+    for (const auto mode : {ModePreference::Auto, ModePreference::LazyDfa}) {
+        searchSpec.requestedMode = mode;
+        plan = dispatcher.decide(searchSpec);
+        assert(plan.kind == (mode == ModePreference::Auto ? AutomatonKind::Dfa : AutomatonKind::LazyDfa));
+        assert(factory.create(plan, parser)->run("TACGTTACGA").matches == longestExpected);
+    }
+
+    // one sequence scans 16 offsets at once with shuffles; several interleave their reads on the table runner
+    PatternSpec batchSpec = spec;
+    batchSpec.requestedMode = ModePreference::Dfa;
+    RunnerFactory::Snapshot batchSnapshot;
+    factory.create(dispatcher.decide(batchSpec), parser, &batchSnapshot);
+    assert(batchSnapshot.dfaKernel.rfind("shuffle", 0) == 0);
+    batchSpec.datasets = {"ACGTTACG", "TTACGACG"};
+    auto batchRunner = factory.create(dispatcher.decide(batchSpec), parser, &batchSnapshot);
+    assert(batchSnapshot.dfaKernel == "table");
+    const auto batch = batchRunner->runBatch(batchSpec.datasets);
+    assert(batch.size() == 2 && batch[1].matches == batchRunner->run("TTACGACG").matches);
+
+    PatternSpec cappedSpec = spec;
+    cappedSpec.pattern = "(A|C)*A(A|C)(A|C)(A|C)";
+    cappedSpec.requestedMode = ModePreference::Dfa;
+    cappedSpec.maxDfaStates = 4;
+    plan = dispatcher.decide(cappedSpec);
+    RunnerFactory::Snapshot cappedSnapshot;
+    auto cappedRunner = factory.create(plan, parser, &cappedSnapshot);
+    assert(cappedSnapshot.kind == AutomatonKind::LazyDfa);
+    assert(!cappedSnapshot.fallbackReason.empty());
+    cappedSpec.requestedMode = ModePreference::Nfa;
+    auto uncappedRunner = factory.create(dispatcher.decide(cappedSpec), parser);
+    assert(cappedRunner->run("CACCAAC").matches == uncappedRunner->run("CACCAAC").matches);
+
     PatternSpec efaSpec = spec;
     efaSpec.pattern = "ACGT";
     efaSpec.mismatchBudget = 1;
@@ -39,6 +88,22 @@ void runIntegrationTests() {
     auto efaRegexResult = efaRegexRunner->run("ATGTTG");
     assert(!efaRegexResult.matches.empty());
 
+    // edit distance runs on Myers' bit vectors, so budgets past the simulation's byte costs still work
+    PatternSpec editSpec = spec;
+    editSpec.pattern.clear();
+    for (int i = 0; i < 400; ++i) {
+        editSpec.pattern += "ACGGTCA"[i % 7];
+    }
+    editSpec.mismatchBudget = 300;
+    editSpec.distance = DistanceMetric::Edit;
+    editSpec.requestedMode = ModePreference::Efa;
+    plan = dispatcher.decide(editSpec);
+    RunnerFactory::Snapshot editSnapshot;
+    auto editRunner = factory.create(plan, parser, &editSnapshot);
+    assert(editSnapshot.kind == AutomatonKind::Efa);
+    const auto editResult = editRunner->run(editSpec.pattern.substr(0, 200));
+    assert(!editResult.matches.empty() && editResult.distances.front() <= 300);
+
     PatternSpec pdaSpec;
     pdaSpec.allowDotBracket = true;
     pdaSpec.requestedMode = ModePreference::Pda;
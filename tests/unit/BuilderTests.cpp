@@ -1,6 +1,13 @@
 #include <cassert>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "automata/builders/Builders.hpp"
+#include "automata/utils/CppEmitter.hpp"
+#include "automata/utils/StateSet.hpp"
 #include "parser/Parsers.hpp"
 
 using namespace automata;
@@ -10,15 +17,174 @@ void runBuilderTests() {
     NfaBuilder nfaBuilder(parser);
     auto nfa = nfaBuilder.build("A|C");
     assert(!nfa.states.empty());
+    assert(nfa.closureOffsets.size() == nfa.states.size() + 1);
+    assert(nfa.closureStates[nfa.closureOffsets[nfa.start]] == nfa.start);
+    assert(nfa.closureOffsets[nfa.start + 1] - nfa.closureOffsets[nfa.start] == 3);
+    StateSet closure(nfa.states.size());
+    epsilonClosure(nfa, {nfa.start}, closure);
+    assert(closure.size() == 3 && closure.contains(nfa.start));
+    closure.clear();
+    assert(closure.empty() && !closure.contains(nfa.start));
     DfaBuilder dfaBuilder;
     auto dfa = dfaBuilder.build(nfa);
     assert(!dfa.states.empty());
+    // the A and C branches lead to equivalent accepting states
+    assert(dfa.states.size() == 3);
+    auto minimized = dfaBuilder.minimize(dfa);
+    assert(minimized.states.size() == 2);
+    assert(minimized.next(minimized.start, 'A') == minimized.next(minimized.start, 'C'));
+    // A and C split the bytes into {A}, {C} and everything else
+    assert(dfa.classes.count == 3);
+    assert(dfa.transitions.size() == dfa.states.size() * dfa.classes.count);
+
+    // one class per byte value: 256^8 columns would wrap to zero, so the stride must clamp instead
+    Dfa everyByte;
+    everyByte.states.resize(2);
+    everyByte.states[1].accept = true;
+    everyByte.classes.count = 256;
+    everyByte.classes.representatives.clear();
+    for (std::size_t byte = 0; byte < 256; ++byte) {
+        everyByte.classes.map[byte] = static_cast<std::uint8_t>(byte);
+        everyByte.classes.representatives.push_back(static_cast<unsigned char>(byte));
+    }
+    everyByte.transitions.assign(2 * 256, 1);
+    auto unstrided = dfaBuilder.withStride(everyByte, 8);
+    assert(unstrided.stride == 1 && unstrided.strideColumns == 0 && unstrided.strided.empty());
+    // 64 classes still fit the column cap two symbols at a time
+    everyByte.classes.count = 64;
+    everyByte.classes.representatives.resize(64);
+    for (std::size_t byte = 0; byte < 256; ++byte) {
+        everyByte.classes.map[byte] = static_cast<std::uint8_t>(byte % 64);
+    }
+    everyByte.transitions.assign(2 * 64, 1);
+    auto paired = dfaBuilder.withStride(everyByte, 8);
+    assert(paired.stride == 2 && paired.strideColumns == 64 * 64);
+    assert(paired.strided.size() == paired.states.size() * paired.strideColumns);
+
+    // required literals: a leading factor sits at offset 0, a factor after a variable-length part gets a window
+    auto sites = nfaBuilder.build("GAATTC(A|T)*");
+    assert(sites.required.literal == "GAATTC" && sites.required.maxOffset == 0);
+    auto spaced = nfaBuilder.build("(A|CC)TTGA");
+    assert(spaced.required.literal == "TTGA");
+    assert(spaced.required.minOffset == 1 && spaced.required.maxOffset == 2);
+    assert(nfaBuilder.build("A*C").required.maxOffset == RequiredFactor::kUnbounded);
+    assert(nfaBuilder.build("(AC|GT)*").required.literal.empty());
+
+    GlushkovBuilder glushkovBuilder(parser);
+    auto glushkov = glushkovBuilder.build("A(CG|T)*");
+    assert(glushkov.positions == 4 && glushkov.first == 0b0001 && !glushkov.nullable);
+    // the loop lets G and T be followed by C or T again
+    assert(glushkov.follow[2] == 0b1010 && glushkov.follow[3] == 0b1010);
+    bool rejected = false;
+    try {
+        glushkovBuilder.build(std::string(65, 'A'));
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
 
     EfaBuilder efaBuilder(parser);
     auto efa = efaBuilder.build("ACGT", 2);
     assert(efa.pattern == "ACGT");
+    bool tooLarge = false;
+    try {
+        efaBuilder.build("ACGT", Efa::kMaxMismatchBudget + 1);
+    } catch (const std::runtime_error&) {
+        tooLarge = true;
+    }
+    assert(tooLarge);
+    // pigeonhole seeds: k + 1 disjoint literals around the wildcard, at fixed offsets
+    const auto seeds = efaBuilder.build("GAATTCGG.ATCCAAGC", 2).seeds;
+    assert(seeds.size() == 3);
+    assert(seeds[0].literal == "GAATTCGG" && seeds[0].minOffset == 0 && seeds[0].maxOffset == 0);
+    assert(seeds[1].literal == "ATCC" && seeds[1].minOffset == 9);
+    assert(seeds[2].literal == "AAGC" && seeds[2].minOffset == 13);
+    assert(efaBuilder.build("GAATTC(A|T)GGATCC", 1).seeds.empty());
+    assert(efaBuilder.build("GAATTCG", 2).seeds.empty());
     assert(efa.mismatchBudget == 2);
     assert(!efa.automaton.states.empty());
+    // the edge layout: consuming edges fused with the epsilon moves after them, each matching a single class
+    const auto& layout = efa.layout;
+    assert(layout.targetOffsets.size() == efa.automaton.states.size() + 1);
+    assert(layout.sources.size() >= 4 && layout.targetOffsets.back() == layout.sources.size());
+    assert(layout.mismatches.size() == layout.classes.count * layout.sources.size());
+    for (std::size_t i = 0; i < layout.sources.size(); ++i) {
+        std::size_t matching = 0;
+        for (std::size_t k = 0; k < layout.classes.count; ++k) {
+            matching += layout.mismatches[k * layout.sources.size() + i] == 0 ? 1 : 0;
+        }
+        assert(matching == 1);
+    }
+
+    {
+        // read the byte-class table and the switch/goto blocks back out of the emitted header
+        DfaBuilder dfaBuilder;
+        auto dfa = dfaBuilder.minimize(dfaBuilder.build(nfaBuilder.build("GA(AT|TC)*[CG]")));
+        const auto source = emitCppScanner(dfa, "GA(AT|TC)*[CG]");
+        std::istringstream lines(source);
+        std::string line;
+        std::vector<int> byteClass;
+        std::vector<int> table(dfa.states.size() * dfa.classes.count, -1);
+        std::vector<bool> accepting(dfa.states.size(), false);
+        bool inClassTable = false;
+        int state = -1;
+        std::vector<std::size_t> cases;
+        bool reports = false;
+        while (std::getline(lines, line)) {
+            if (line.find("kByteClass[256] = {") != std::string::npos) {
+                inClassTable = true;
+                continue;
+            }
+            if (inClassTable) {
+                if (line == "};") {
+                    inClassTable = false;
+                    continue;
+                }
+                std::istringstream values(line);
+                int value = 0;
+                char comma = 0;
+                while (values >> value >> comma) {
+                    byteClass.push_back(value);
+                }
+                continue;
+            }
+            if (line.rfind("    state_", 0) == 0) {
+                state = std::stoi(line.substr(10));
+                continue;
+            }
+            std::size_t at = 0;
+            while ((at = line.find(" case ", at)) != std::string::npos) {
+                at += 6;
+                cases.push_back(std::stoul(line.substr(at)));
+            }
+            if (line.find("matches.emplace_back(start, pos)") != std::string::npos) {
+                reports = true;
+            }
+            const auto jump = line.find("goto state_");
+            if (jump != std::string::npos && !cases.empty()) {
+                const int to = std::stoi(line.substr(jump + 11));
+                for (auto symbolClass : cases) {
+                    table[state * dfa.classes.count + symbolClass] = to;
+                }
+                accepting[to] = accepting[to] || reports;
+                cases.clear();
+                reports = false;
+            }
+        }
+        assert(byteClass.size() == 256);
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            assert(byteClass[byte] == dfa.classes.map[byte]);
+        }
+        assert(table == dfa.transitions);
+        for (std::size_t s = 0; s < dfa.states.size(); ++s) {
+            // only states entered by some transition can report, and those report exactly when accepting
+            bool entered = false;
+            for (int to : dfa.transitions) {
+                entered = entered || to == static_cast<int>(s);
+            }
+            assert(!entered || accepting[s] == dfa.states[s].accept);
+        }
+    }
 
     PdaBuilder pdaBuilder;
     auto pda = pdaBuilder.build();
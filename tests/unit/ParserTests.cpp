@@ -16,6 +16,52 @@ void runParserTests() {
     assert(validator.validate("(()())"));
     assert(!validator.validate("(()"));
     assert(!validator.validate("())("));
+    // long enough for whole 32-byte blocks: the first error is found inside a block, not just at its edge
+    const std::string nested = std::string(40, '(') + std::string(25, '.') + std::string(40, ')');
+    assert(validator.validate(nested) && validator.getMaxDepth(nested) == 40);
+    assert(validator.firstError(nested) == DotBracketScan::npos);
+    assert(validator.firstError(nested + ")" + nested) == nested.size());
+    assert(validator.firstError(nested.substr(1)) == nested.size() - 2);
+    assert(validator.firstError("(" + nested) == nested.size() + 1);
+    auto foreign = nested;
+    foreign[70] = 'A';
+    assert(validator.firstError(foreign) == 70 && validator.getMaxDepth(foreign) == 40);
+    const auto limited = validator.scan(nested, true, 33);
+    assert(limited.stop == 33 && limited.maxDepth == 33);
+    // chunked: the summaries compose, and every split finds the error the sequential scan does
+    const auto whole = validator.summarize(nested + ")");
+    const auto halves = combineSummaries(validator.summarize(nested.substr(0, 50)),
+                                         validator.summarize(nested.substr(50) + ")"));
+    assert(halves.delta == whole.delta && halves.delta == -1);
+    assert(halves.minPrefix == whole.minPrefix && halves.maxPrefix == 40 && halves.length == nested.size() + 1);
+    for (const auto& structure : {nested, nested + ")" + nested, "(" + nested, foreign, nested + nested}) {
+        const auto sequential = validator.scan(structure);
+        for (std::size_t threads : {2, 3, 7}) {
+            const auto chunked = validator.scanChunked(structure, threads);
+            assert(chunked.stop == sequential.stop && chunked.depth == sequential.depth);
+            assert(chunked.maxDepth == sequential.maxDepth);
+        }
+    }
+    assert(validator.scanChunked(nested, 4, true, 33).stop == 33);
+    // the scalar loops agree with the kernel picked for this CPU, including mid-block errors and depth limits
+    DotBracketValidator scalar;
+    scalar.useScalarKernel();
+    for (const auto& structure : {nested, nested + ")" + nested, "(" + nested, foreign, nested.substr(1)}) {
+        for (bool strict : {true, false}) {
+            for (std::size_t limit : {std::size_t{33}, DotBracketScan::npos}) {
+                const auto expected = validator.scan(structure, strict, limit);
+                const auto actual = scalar.scan(structure, strict, limit);
+                assert(actual.stop == expected.stop && actual.depth == expected.depth);
+                assert(actual.maxDepth == expected.maxDepth);
+                const auto chunked = scalar.scanChunked(structure, 3, strict, limit);
+                assert(chunked.stop == expected.stop && chunked.depth == expected.depth);
+            }
+        }
+        const auto expected = validator.summarize(structure);
+        const auto actual = scalar.summarize(structure);
+        assert(actual.delta == expected.delta && actual.minPrefix == expected.minPrefix);
+        assert(actual.maxPrefix == expected.maxPrefix && actual.foreign == expected.foreign);
+    }
 
     std::ofstream file("tmp/test_dataset.txt");
     file << ">seq\nACGT\n";
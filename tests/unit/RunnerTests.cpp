@@ -1,4 +1,9 @@
+#include <algorithm>
 #include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "automata/builders/Builders.hpp"
 #include "automata/runners/Runners.hpp"
@@ -15,6 +20,28 @@ void runRunnerTests() {
         auto result = runner.run("ACGTTACG");
         assert(!result.matches.empty());
     }
+    {
+        auto nfa = nfaBuilder.build("AC*");
+        NfaRunner runner(std::move(nfa), false);
+        auto result = runner.run("ACCA");
+        const std::vector<std::pair<std::size_t, std::size_t>> expected{{0, 1}, {0, 2}, {0, 3}, {3, 4}};
+        assert(result.matches == expected);
+        assert(!result.accepted);
+    }
+    {
+        // attempts that never die merge into one state set, so a scan without matches visits O(n * m) states
+        auto nfa = nfaBuilder.build("A.*T");
+        const auto states = nfa.states.size();
+        NfaRunner runner(std::move(nfa), false);
+        std::string input;
+        for (int i = 0; i < 3000; ++i) {
+            input += "ACG";
+        }
+        const auto result = runner.run(input);
+        assert(result.matches.empty() && result.statesVisited <= input.size() * states);
+        const std::vector<std::pair<std::size_t, std::size_t>> expected{{0, 4}, {0, 6}, {4, 6}};
+        assert(runner.run("ACGTAT").matches == expected);
+    }
     {
         auto nfa = nfaBuilder.build("ACG");
         DfaBuilder dfaBuilder;
@@ -23,6 +50,264 @@ void runRunnerTests() {
         auto result = runner.run("ACGTTACG");
         assert(!result.matches.empty());
     }
+    {
+        auto nfa = nfaBuilder.build("A(CG|TT)*");
+        DfaBuilder dfaBuilder;
+        DfaRunner reference(dfaBuilder.build(nfa), false);
+        // a budget this small forces flushes, and repeated flushing falls back to NFA simulation
+        LazyDfaRunner tiny(nfa, 2048, false);
+        LazyDfaRunner roomy(nfa, 1 << 20, false);
+        const auto expected = reference.run("TACGTTACGA");
+        assert(tiny.run("TACGTTACGA").matches == expected.matches);
+        assert(roomy.run("TACGTTACGA").matches == expected.matches);
+        assert(roomy.cacheFlushes() == 0);
+    }
+    {
+        auto nfa = nfaBuilder.build("A(CG|TT)*");
+        DfaBuilder dfaBuilder;
+        auto dfa = dfaBuilder.minimize(dfaBuilder.build(nfa));
+        const auto expected = DfaRunner(dfa, false).run("TACGTTACGA");
+        // odd-length input leaves a tail that the strided loop hands back to single steps
+        for (std::size_t stride : {2, 4}) {
+            auto strided = dfaBuilder.withStride(dfa, stride);
+            assert(strided.stride == stride && strided.strided.size() == strided.states.size() * strided.strideColumns);
+            const auto result = DfaRunner(std::move(strided), false).run("TACGTTACGA");
+            assert(result.matches == expected.matches);
+            assert(result.statesVisited == expected.statesVisited);
+        }
+    }
+    {
+        // a long literal has enough states that the byte budget, not the column cap, picks the stride
+        std::string literal;
+        for (int i = 0; i < 200; ++i) {
+            literal += "ACGT";
+        }
+        DfaBuilder dfaBuilder;
+        auto dfa = dfaBuilder.minimize(dfaBuilder.build(nfaBuilder.build(literal)));
+        auto strided = dfaBuilder.withStride(dfa, 8);
+        // five byte classes allow stride 5 under the column cap, but 801 states x 3125 columns exceed the budget
+        assert(dfa.classes.count == 5 && strided.stride == 4);
+        assert(strided.strided.size() * sizeof(DfaStrideStep) <= DfaBuilder::kMaxStrideTableBytes);
+        assert(strided.strideColumns <= DfaBuilder::kMaxStrideColumns);
+        const auto input = "TT" + literal + "A" + literal;
+        const auto expected = DfaRunner(dfa, false).run(input);
+        const auto result = DfaRunner(std::move(strided), false).run(input);
+        assert(result.matches == expected.matches && result.matches.size() == 2);
+    }
+    {
+        auto nfa = nfaBuilder.build("A(CG|TT)*");
+        DfaBuilder dfaBuilder;
+        auto dfa = dfaBuilder.minimize(dfaBuilder.build(nfa));
+        assert(ShuffleDfaRunner::fits(dfa));
+        // longer than one 16-lane block so attempts carry across block boundaries
+        const std::string input = "TACGTTACGAACGCGTTTTACGCGACGTTA";
+        const auto expected = DfaRunner(dfa, false).run(input);
+        // the kernel picked for this CPU, then the scalar one
+        for (bool scalar : {false, true}) {
+            ShuffleDfaRunner runner(dfa);
+            if (scalar) {
+                runner.useScalarKernel();
+                assert(!runner.vectorized());
+            }
+            const auto result = runner.run(input);
+            assert(result.matches == expected.matches);
+            assert(result.statesVisited == expected.statesVisited);
+        }
+    }
+    {
+        // more inputs than lanes, including empty ones, so lanes retire and pick up new inputs
+        auto nfa = nfaBuilder.build("A(CG|TT)*|C*");
+        DfaBuilder dfaBuilder;
+        DfaRunner runner(dfaBuilder.build(nfa), false);
+        const std::vector<std::string> inputs = {"TACGTTACGA", "", "ACG", "CCC", "GGGG", "ATTATT", "A", "",
+                                                 "CACGC", "TTTT", "ACGACGACGTT", "C"};
+        const auto batch = runner.runBatch(inputs);
+        assert(batch.size() == inputs.size());
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            const auto single = runner.run(inputs[i]);
+            assert(batch[i].matches == single.matches);
+            assert(batch[i].accepted == single.accepted);
+            assert(batch[i].statesVisited == single.statesVisited);
+        }
+    }
+    {
+        GlushkovBuilder glushkovBuilder(parser);
+        ShiftAndRunner runner(glushkovBuilder.build("A(CG|TT)*"), false);
+        NfaRunner reference(nfaBuilder.build("A(CG|TT)*"), false);
+        const auto result = runner.run("TACGTTACGA");
+        assert(result.matches == reference.run("TACGTTACGA").matches);
+        assert(runner.run("ACG").accepted);
+    }
+    {
+        GlushkovBuilder glushkovBuilder(parser);
+        const auto chain = glushkovBuilder.build("AC[GT].");
+        assert(WuManberRunner::fits(chain));
+        assert(!WuManberRunner::fits(glushkovBuilder.build("A(CG|TT)*")));
+        EfaBuilder builder(parser);
+        const auto expected = EfaRunner(builder.build("AC[GT].", 1), false).run("TACCATTCGA");
+        const auto result = WuManberRunner(chain, 1, false).run("TACCATTCGA");
+        assert(result.matches == expected.matches);
+    }
+    {
+        // an exact chain skips every offset its required literal rules out, with the same intervals
+        GlushkovBuilder glushkovBuilder(parser);
+        WuManberRunner exact(glushkovBuilder.build("GAATTC"), 0, false);
+        const std::string input = "ACGTGAATTCAGGAATTCT";
+        const std::vector<std::pair<std::size_t, std::size_t>> expected{{4, 10}, {12, 18}};
+        const auto result = exact.run(input);
+        assert(result.matches == expected && result.statesVisited == 12);
+        assert(exact.run("ACGTACGTGAATTAC").statesVisited == 0);
+    }
+    {
+        // overlapping attempts from different starts are carried in one pass and reported start-major
+        EfaBuilder builder(parser);
+        EfaRunner runner(builder.build("AC*", 0), false);
+        const std::vector<std::pair<std::size_t, std::size_t>> expected{{0, 1}, {0, 2}, {0, 3}, {3, 4}};
+        assert(runner.run("ACCA").matches == expected);
+    }
+    {
+        // the lane kernel steps 32 starts at once; the traced run keeps the thread simulation, and both agree
+        // across block boundaries
+        EfaBuilder builder(parser);
+        std::string input;
+        for (int i = 0; i < 150; ++i) {
+            input += "ACGTTGCA"[(i * 5) % 8];
+        }
+        for (std::size_t budget = 0; budget <= 3; ++budget) {
+            const auto efa = builder.build("A(CG|TT)*G", budget);
+            const auto threads = EfaRunner(efa, true).run(input);
+            // the kernel picked for this CPU, then the scalar one
+            for (bool scalar : {false, true}) {
+                EfaRunner runner(efa, false);
+                if (scalar) {
+                    runner.useScalarKernel();
+                    assert(!runner.vectorized());
+                }
+                const auto lanes = runner.run(input);
+                assert(!lanes.matches.empty() && lanes.matches == threads.matches);
+                assert(lanes.accepted == threads.accepted && lanes.statesVisited == threads.statesVisited);
+            }
+        }
+        assert(EfaRunner(builder.build("ACG.", 1), false).run("TCGA").accepted);
+    }
+    {
+        // seeds only skip starts that cannot match: intervals and costs equal the unseeded scan, including a copy
+        // whose one intact seed lies inside the first m + k bytes and copies that run to the end of the input
+        EfaBuilder builder(parser);
+        const std::string copy = "GAATTCGGTATCCAAGC";
+        auto early = copy;
+        early[1] = 'T';
+        early[10] = 'G';
+        auto late = copy;
+        late[3] = 'C';
+        late[14] = 'T';
+        const auto body = "TT" + early + "CATTAG" + copy + "GGCA" + late;
+        for (const auto& input : {body, body.substr(0, body.size() - 2)}) {
+            for (std::size_t budget : {1, 2}) {
+                const auto seeded = builder.build("GAATTCGG.ATCCAAGC", budget);
+                assert(seeded.seeds.size() == budget + 1);
+                auto unseeded = seeded;
+                unseeded.seeds.clear();
+                const auto expected = EfaRunner(unseeded, false).run(input);
+                const auto actual = EfaRunner(seeded, false).run(input);
+                assert(!actual.matches.empty() && actual.matches == expected.matches);
+                assert(actual.accepted == expected.accepted);
+                EfaRunner rankedSeeded(seeded, false);
+                EfaRunner rankedUnseeded(unseeded, false);
+                rankedSeeded.setReportLimit(100);
+                rankedUnseeded.setReportLimit(100);
+                const auto costs = rankedSeeded.run(input);
+                const auto expectedCosts = rankedUnseeded.run(input);
+                assert(costs.matches == expectedCosts.matches && costs.distances == expectedCosts.distances);
+            }
+            const auto first = EfaRunner(builder.build("GAATTCGG.ATCCAAGC", 2), false).run(input).matches;
+            assert(first.front() == std::make_pair(std::size_t{2}, std::size_t{2} + copy.size()));
+        }
+        const auto last = EfaRunner(builder.build("GAATTCGG.ATCCAAGC", 2), false).run(body).matches;
+        const auto tail = std::make_pair(body.size() - copy.size(), body.size());
+        assert(std::find(last.begin(), last.end(), tail) != last.end());
+    }
+    {
+        // ranked reports keep the cheapest hits only, cheapest first
+        EfaBuilder builder(parser);
+        EfaRunner best(builder.build("ACG", 1), false);
+        best.setReportLimit(1);
+        const auto single = best.run("TTAGGTTACGTT");
+        assert(single.matches.size() == 1 && single.matches[0] == std::make_pair(std::size_t{7}, std::size_t{10}));
+        assert(single.distances == std::vector<std::size_t>{0});
+        EfaRunner top(builder.build("ACG", 1), false);
+        top.setReportLimit(3);
+        const auto ranked = top.run("TTAGGTTACGTT");
+        assert(ranked.distances == (std::vector<std::size_t>{0, 1}));
+        assert(ranked.matches[1] == std::make_pair(std::size_t{2}, std::size_t{5}));
+    }
+    {
+        // edit distance: a deletion costs one, and the interval covers the closest alignment
+        EfaBuilder builder(parser);
+        MyersRunner runner(builder.buildEditPattern("ACGTACGT"), 1, false);
+        const auto result = runner.run("TTACGACGTTT");
+        assert(!result.matches.empty() && result.matches.size() == result.distances.size());
+        assert(result.matches[0] == std::make_pair(std::size_t{2}, std::size_t{9}) && result.distances[0] == 1);
+        assert(MyersRunner(builder.buildEditPattern("ACGTACGT"), 1, false).run("ACGTTACGT").accepted);
+        // a pattern over several words: an insertion in the middle of a 100-symbol read
+        std::string read;
+        for (int i = 0; i < 100; ++i) {
+            read += "ACGGTCA"[i % 7];
+        }
+        auto mutated = read;
+        mutated.insert(50, "T");
+        const auto blocked = MyersRunner(builder.buildEditPattern(read), 2, false).run("GG" + mutated + "GG");
+        const auto whole = std::make_pair(std::size_t{2}, std::size_t{103});
+        assert(std::find(blocked.matches.begin(), blocked.matches.end(), whole) != blocked.matches.end());
+        // every recovered start gives an alignment no longer than m + d
+        for (std::size_t i = 0; i < blocked.matches.size(); ++i) {
+            const auto [start, end] = blocked.matches[i];
+            assert(end - start >= read.size() - blocked.distances[i]);
+            assert(end - start <= read.size() + blocked.distances[i]);
+        }
+        bool rejected = false;
+        try {
+            builder.buildEditPattern("A(C|G)T");
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    {
+        // the determinized (state, mismatches) product reports the simulated intervals
+        EfaBuilder builder(parser);
+        DfaBuilder dfaBuilder;
+        const auto efa = builder.build("A(CG|TT)*G", 1);
+        const auto dfa = dfaBuilder.minimize(builder.determinize(efa, 10000));
+        const std::string input = "ATGTTGACGGCG";
+        assert(DfaRunner(dfa, false).run(input).matches == EfaRunner(efa, false).run(input).matches);
+        const auto exact = builder.determinize(builder.build("ACG", 1), 10000);
+        const int afterExact = exact.next(exact.next(exact.next(exact.start, 'A'), 'C'), 'G');
+        const int afterMismatch = exact.next(exact.next(exact.next(exact.start, 'A'), 'T'), 'G');
+        assert(exact.states[afterExact].accept && exact.states[afterMismatch].accept);
+        assert(exact.states[afterExact].mismatches == 0 && exact.states[afterMismatch].mismatches == 1);
+        // each interval carries the same distance the ranked simulation gives it, on every DFA kernel
+        const auto tabled = DfaRunner(dfa, false).run(input);
+        assert(tabled.distances.size() == tabled.matches.size());
+        EfaRunner ranked(efa, false);
+        ranked.setReportLimit(1000);
+        const auto hits = ranked.run(input);
+        assert(hits.matches.size() == tabled.matches.size());
+        for (std::size_t i = 0; i < hits.matches.size(); ++i) {
+            const auto at = std::find(tabled.matches.begin(), tabled.matches.end(), hits.matches[i]);
+            assert(at != tabled.matches.end() && tabled.distances[at - tabled.matches.begin()] == hits.distances[i]);
+        }
+        assert(ShuffleDfaRunner::fits(dfa));
+        ShuffleDfaRunner shuffled(dfa);
+        const auto vectorized = shuffled.run(input);
+        shuffled.useScalarKernel();
+        const auto scalar = shuffled.run(input);
+        assert(vectorized.matches == tabled.matches && vectorized.distances == tabled.distances);
+        assert(scalar.matches == tabled.matches && scalar.distances == tabled.distances);
+        const auto batch = DfaRunner(dfa, false).runBatch({input, "ACGG"});
+        assert(batch[0].distances == tabled.distances);
+        assert(batch[1].distances == DfaRunner(dfa, false).run("ACGG").distances);
+    }
     {
         EfaBuilder builder(parser);
         auto efa = builder.build("ACG", 1);
@@ -51,4 +336,15 @@ void runRunnerTests() {
         auto result = runner.run("(()())");
         assert(result.accepted);
     }
+    {
+        // the untraced bracket PDA runs as one scan and stops where the stepped (traced) loop does
+        const auto pda = PdaBuilder().build(12);
+        const std::string nested = std::string(12, '(') + std::string(30, '.') + std::string(12, ')');
+        for (const auto& input : {nested, nested + "(" + nested + ")", "(" + nested + ")", nested + ")..", nested + "x"}) {
+            const auto scanned = PdaRunner(pda, false).run(input);
+            const auto stepped = PdaRunner(pda, true).run(input);
+            assert(scanned.accepted == stepped.accepted && scanned.matches == stepped.matches);
+            assert(scanned.statesVisited == stepped.statesVisited && scanned.stackDepth == stepped.stackDepth);
+        }
+    }
 }